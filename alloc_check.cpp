@@ -0,0 +1,129 @@
+/*
+* Justin W Li
+* alloc_check.cpp
+* checks that a game's turns allocate nothing once warmed up, by counting every call to the global operator new
+* plays a session, then replays it on the same game -- the replay must not allocate between its first and last word
+* built as C++20, the coroutine engine is checked too; every engine is checked with and without --strikes
+* usage: alloc_check [words] [seed]
+*	words -- words the scripted player types each session (default 4000)
+*	seed -- session seed (default 1)
+* exits with 1 if any engine allocates after warm-up
+*/
+
+#include "game_loop.h"
+#include "game_io.h"
+#include <atomic>		//std::atomic
+#include <cstdio>		//std::printf, std::fputs
+#include <cstdlib>		//std::malloc, std::free, std::strtoul, std::strtoull
+#include <new>			//std::bad_alloc
+#include <string>		//std::string
+
+//every allocation of the program, on any thread
+static std::atomic<unsigned long> allocations(0);
+
+void* operator new(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+//scripted player that notes how many allocations there have been each time it is asked for a word
+class counting_io : public scripted_io {
+	unsigned long first;			//allocations when first asked for a word
+	unsigned long last;				//allocations when last asked for a word from the script
+	unsigned long words;			//words asked for from the script
+
+public:
+	explicit counting_io(const std::string& script) : scripted_io(script), first(0), last(0), words(0) {}
+
+	void read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point deadline) {
+		//only turns played from the script count -- dying and quitting once it runs out happen once a session
+		if (!done())
+		{
+			last = allocations.load(std::memory_order_relaxed);
+			if (words++ == 0)
+				first = last;
+		}
+		scripted_io::read_word(typed, target, deadline);
+	}
+
+	void restart() {
+		scripted_io::restart();
+		first = last = words = 0;
+	}
+	unsigned long made() const { return last - first; }		//allocations between first and last word
+	unsigned long asked() const { return words; }
+};
+
+//engines checked
+enum engine_t { VIRTUAL, FLAT, CORO, ENGINES };
+
+//plays one session on a game, through io
+static void play(game_loop& gl, int engine, game_io& io) {
+	gl.set_io(io);
+	if (engine == FLAT)
+		gl.run_flat();
+#ifdef GOBLINS_COROUTINES
+	else if (engine == CORO)
+		gl.run_coro();
+#endif
+	else
+		gl.run();
+}
+
+//plays a session to warm up, then the same one again; returns allocations made between the first and last word
+//of the second -- the first grew every pool, list and buffer as far as this session needs, so none should grow
+static unsigned long check(int engine, bool strikes, std::uint64_t seed, const std::string& script) {
+	game_loop gl(seed);
+	gl.set_strikes(strikes);
+	gl.wait_words();
+	counting_io io(script);
+	play(gl, engine, io);
+	const unsigned long warm_up = io.made();
+
+	gl.restart(seed);
+	io.restart();
+	play(gl, engine, io);
+	std::printf("%lu words: %lu allocations warming up, %lu after\n", io.asked(), warm_up, io.made());
+	return io.made();
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned long words = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000;
+	const std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+	try {
+		const char* names[ENGINES] = { "virtual (event_handler)", "flat (event_engine)", "coroutine (coro_engine)" };
+#ifdef GOBLINS_COROUTINES
+		const int engines = ENGINES;
+#else
+		const int engines = CORO;
+#endif
+		std::string script;
+		for (unsigned long i = 1; i <= words; ++i)
+			script += (i % 3 == 0) ? "zz " : "* ";		//hits, misses, kills and level ups all come up
+
+		bool failed = false;
+		for (int strikes = 0; strikes < 2; ++strikes)
+		{
+			for (int engine = 0; engine < engines; ++engine)
+			{
+				std::printf("%s%s: ", names[engine], strikes ? ", --strikes" : "");
+				if (check(engine, strikes != 0, seed, script) != 0)
+					failed = true;
+			}
+		}
+		return failed ? 1 : 0;
+	}
+	catch (const char* e) {
+		std::fputs(e, stderr);
+		return 1;
+	}
+}
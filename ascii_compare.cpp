@@ -0,0 +1,215 @@
+/*
+* Justin W Li
+* ascii_compare.cpp
+* case-insensitive ascii comparison kernel implementations
+*/
+
+#include "ascii_compare.h"
+#include <cstdint>      //std::uint32_t
+#include <cstring>      //std::memcpy
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ASCII_X86
+#include <immintrin.h>  //sse2, avx2 intrinsics
+#ifdef _MSC_VER
+#include <intrin.h>     //__cpuid, __cpuidex
+#define SSE2_TARGET
+#define AVX2_TARGET
+#else
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+//compares n bytes starting at lhs, rhs
+typedef bool (*iequal_kernel)(const char* lhs, const char* rhs, std::size_t n);
+
+//-----------------------
+//----SCALAR FALLBACK----
+//-----------------------
+
+//upper case of an ascii letter; other bytes are left alone
+static inline unsigned char fold(char c) {
+	unsigned char u = static_cast<unsigned char>(c);
+	return (static_cast<unsigned int>(u - 'a') < 26u) ? static_cast<unsigned char>(u - ('a' - 'A')) : u;
+}
+
+static bool iequal_scalar(const char* lhs, const char* rhs, std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		if (fold(lhs[i]) != fold(rhs[i]))
+			return false;
+	}
+	return true;
+}
+
+#ifdef ASCII_X86
+
+//-------------------
+//----SSE2 KERNEL----
+//-------------------
+
+//sets the 0x20 bit of every upper case letter
+SSE2_TARGET static inline __m128i fold16(__m128i c) {
+	//shift 'A'..'Z' onto -128..-103 so one signed compare finds them
+	const __m128i shifted = _mm_add_epi8(c, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+	const __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+	return _mm_or_si128(c, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+//bitmask of matching bytes of 16-byte blocks
+SSE2_TARGET static inline unsigned int match16(__m128i lhs, __m128i rhs) {
+	return static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(fold16(lhs), fold16(rhs))));
+}
+
+SSE2_TARGET static inline unsigned int match16(const char* lhs, const char* rhs) {
+	return match16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs)),
+		_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs)));
+}
+
+//4 to 15 bytes at p as one block -- its first and last 8 bytes, or first and last 4, overlapping in the middle,
+//so nothing past the word is read
+SSE2_TARGET static inline __m128i load_short(const char* p, std::size_t n) {
+	if (n >= 8)
+		return _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)),
+			_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + n - 8)));
+	std::uint32_t first, last;
+	std::memcpy(&first, p, 4);
+	std::memcpy(&last, p + n - 4, 4);
+	return _mm_set_epi32(0, 0, static_cast<int>(last), static_cast<int>(first));
+}
+
+SSE2_TARGET static bool iequal_sse2(const char* lhs, const char* rhs, std::size_t n) {
+	if (n >= 16)
+	{
+		//whole blocks, then one block overlapping the end
+		std::size_t i = 0;
+		for (; i + 16 <= n; i += 16)
+		{
+			if (match16(lhs + i, rhs + i) != 0xFFFF)
+				return false;
+		}
+		return i == n || match16(lhs + n - 16, rhs + n - 16) == 0xFFFF;
+	}
+
+	//short word -- one block of its two halves; the shortest are not worth it
+	if (n < 4)
+		return iequal_scalar(lhs, rhs, n);
+	const unsigned int mask = n >= 8 ? 0xFFFF : 0xFF;
+	return (match16(load_short(lhs, n), load_short(rhs, n)) & mask) == mask;
+}
+
+//-------------------
+//----AVX2 KERNEL----
+//-------------------
+
+AVX2_TARGET static inline __m256i fold32(__m256i c) {
+	const __m256i shifted = _mm256_add_epi8(c, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+	const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), shifted);
+	return _mm256_or_si256(c, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+AVX2_TARGET static inline std::uint32_t match32(const char* lhs, const char* rhs) {
+	const __m256i l = fold32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs)));
+	const __m256i r = fold32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs)));
+	return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)));
+}
+
+AVX2_TARGET static bool iequal_avx2(const char* lhs, const char* rhs, std::size_t n) {
+	if (n >= 32)
+	{
+		std::size_t i = 0;
+		for (; i + 32 <= n; i += 32)
+		{
+			if (match32(lhs + i, rhs + i) != 0xFFFFFFFFu)
+				return false;
+		}
+		return i == n || match32(lhs + n - 32, rhs + n - 32) == 0xFFFFFFFFu;
+	}
+
+	//shorter than a block -- two overlapping 16-byte blocks, or a short word
+	return iequal_sse2(lhs, rhs, n);
+}
+
+//--------------------
+//----CPU DISPATCH----
+//--------------------
+
+static bool cpu_has_avx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0)	//osxsave -- os saves ymm registers
+		return false;
+	if ((_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool cpu_has_sse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+	return true;	//part of x86-64
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static iequal_kernel select_kernel(const char** name) {
+	if (cpu_has_avx2())
+	{
+		*name = "avx2";
+		return iequal_avx2;
+	}
+	if (cpu_has_sse2())
+	{
+		*name = "sse2";
+		return iequal_sse2;
+	}
+	*name = "scalar";
+	return iequal_scalar;
+}
+
+#else
+
+static iequal_kernel select_kernel(const char** name) {
+	*name = "scalar";
+	return iequal_scalar;
+}
+
+#endif
+
+static const char* kernel_name = "scalar";
+static const iequal_kernel kernel = select_kernel(&kernel_name);
+
+//------------------
+//----PUBLIC API----
+//------------------
+
+bool ascii_iequal(std::string_view lhs, std::string_view rhs) {
+	return lhs.size() == rhs.size() && kernel(lhs.data(), rhs.data(), lhs.size());
+}
+
+std::size_t ascii_iequal_any(std::string_view str, const std::string_view* candidates, std::size_t count) {
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		//lengths reject most candidates without touching their bytes
+		if (candidates[i].size() == str.size() && kernel(str.data(), candidates[i].data(), str.size()))
+			return i;
+	}
+	return count;
+}
+
+const char* ascii_kernel_name() { return kernel_name; }
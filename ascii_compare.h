@@ -0,0 +1,23 @@
+/*
+* Justin W Li
+* ascii_compare.h
+* case-insensitive ascii comparison kernels
+*/
+
+#ifndef ASCII_COMPARE_H
+#define ASCII_COMPARE_H
+
+#include <cstddef>		//std::size_t
+#include <string_view>	//std::string_view
+
+//returns whether lhs and rhs match, ignoring ascii case
+//uses the widest kernel the cpu supports (avx2, sse2, or scalar), picked once at startup
+bool ascii_iequal(std::string_view lhs, std::string_view rhs);
+
+//returns index of first candidate matching str, ignoring ascii case; returns count if none match
+std::size_t ascii_iequal_any(std::string_view str, const std::string_view* candidates, std::size_t count);
+
+//name of kernel picked by cpu dispatch -- "avx2", "sse2" or "scalar"
+const char* ascii_kernel_name();
+
+#endif
@@ -0,0 +1,69 @@
+/*
+* Justin W Li
+* bot_io.cpp
+* synthetic player function implementations
+*/
+
+#include "bot_io.h"
+#include <cmath>		//std::exp, std::log, std::sqrt, std::cos
+
+//ctor -- starts bot's clock at real time, though only differences on it are ever read
+bot_io::bot_io(const model& m_, std::uint64_t seed, std::ostream* text_) :
+	game_io(text_), m(m_), gen(seed), start_t(std::chrono::steady_clock::now()), clock(start_t), deaths(0), quitting(false)
+{
+	if (m.wpm <= 0)
+		throw "bot_io(): Typing speed must be positive!\n";
+}
+
+void bot_io::restart(std::uint64_t seed) {
+	gen.seed(seed);
+	clock = start_t;
+	deaths = 0;
+	quitting = false;
+}
+
+double bot_io::elapsed() const { return std::chrono::duration<double>(clock - start_t).count(); }
+
+//top 53 bits, so every value is exactly representable; never 0, so it is safe to take the log of
+double bot_io::uniform() { return ((gen.next() >> 11) + 1) * (1.0 / 9007199254740992.0); }
+
+//box-muller transform
+double bot_io::normal() {
+	const double PI = 3.14159265358979323846;
+	return std::sqrt(-2.0 * std::log(uniform())) * std::cos(2.0 * PI * uniform());
+}
+
+//deadline is left to combat -- it is checked against the bot's clock
+void bot_io::read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point) {
+	if (quitting)
+	{
+		typed.clear();
+		return;
+	}
+	typed.assign(target.data(), target.size());
+
+	//5 letters to a word, so a letter takes 12000 / wpm ms
+	double ms = (m.reaction_ms + target.size() * 12000.0 / m.wpm) * std::exp(m.spread * normal());
+	clock += std::chrono::microseconds(static_cast<long long>(ms * 1000));
+
+	//miss by one letter
+	if (uniform() > m.accuracy && !typed.empty())
+	{
+		char& c = typed[gen.bounded(typed.size())];
+		c = (c == 'q' || c == 'Q') ? 'z' : 'q';
+	}
+}
+
+void bot_io::read_choice(std::string& typed, std::string_view pass, std::string_view fail) {
+	std::string_view word = pass;
+	if (quitting)
+		word = fail;
+	else if (pass == "Yes")		//asked to continue after dying
+	{
+		if (deaths < m.continues)
+			++deaths;
+		else
+			word = fail;
+	}
+	typed.assign(word.data(), word.size());
+}
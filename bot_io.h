@@ -0,0 +1,65 @@
+/*
+* Justin W Li
+* bot_io.h
+* synthetic player class definition
+*/
+
+#ifndef BOT_IO_H
+#define BOT_IO_H
+
+#include "game_io.h"
+#include "rng.h"
+
+#include <chrono>		//std::chrono::steady_clock
+#include <cstdint>		//std::uint64_t
+#include <string>		//std::string
+#include <string_view>	//std::string_view
+
+//--------------------
+//----BOT IO CLASS----
+//--------------------
+
+//plays the game as a modelled typist, for simulating sessions in bulk
+//every word takes the bot a reaction time, plus its letters at the model's speed, scaled by random noise --
+//that time passes on the bot's own clock, which combat is timed against, so a whole session runs in no real time
+//words it gets wrong are near misses, one letter off, so graded play gives them partial credit
+class bot_io : public game_io {
+public:
+	//how the bot types
+	struct model {
+		double accuracy;		//chance of typing each word right
+		double wpm;				//typing speed, in words per minute of five letters
+		double spread;			//noise on each word's typing time -- standard deviation of its log
+		double reaction_ms;		//time to read a word before typing starts
+		unsigned int continues;	//deaths the bot plays on through before it quits
+
+		model() : accuracy(0.9), wpm(60), spread(0.25), reaction_ms(400), continues(3) {}
+	};
+
+private:
+	model m;
+	rng gen;								//bot's own generator -- kept apart from the session's, so the game plays the
+											//same for the same seed whatever the bot does
+	std::chrono::steady_clock::time_point start_t;
+	std::chrono::steady_clock::time_point clock;	//bot's clock
+	unsigned int deaths;					//deaths continued through so far
+	bool quitting;							//whether bot has given up
+
+	double uniform();						//random number in (0, 1]
+	double normal();						//random number from standard normal distribution
+
+public:
+	bot_io(const model& m_, std::uint64_t seed, std::ostream* text_ = nullptr);	//prints nothing unless given text_
+
+	void restart(std::uint64_t seed);		//new session -- clock, deaths and generator start over
+	void give_up() { quitting = true; }		//misses every word and turns down every choice from now on
+	bool gave_up() const { return quitting; }
+	double elapsed() const;					//seconds of play on bot's clock
+
+	void read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point deadline);
+	void read_choice(std::string& typed, std::string_view pass, std::string_view fail);	//continues while it can
+	void wait_enter() {}
+	std::chrono::steady_clock::time_point now() { return clock; }
+};
+
+#endif
@@ -0,0 +1,146 @@
+/*
+* Justin W Li
+* compare_bench.cpp
+* checks the case-insensitive compare kernel picked for this cpu against a plain loop, and times the two
+* usage: compare_bench [pairs] [rounds]
+*	pairs -- random pairs checked against the plain loop (default 2000000)
+*	rounds -- passes timed over each length; the fastest is reported (default 5)
+* every word sits in a buffer of exactly its size, so built with -fsanitize=address, a read past one is caught
+* exits with 1 if the kernel and the loop disagree on any pair
+*/
+
+#include "ascii_compare.h"
+#include "rng.h"
+
+#include <cctype>		//std::toupper
+#include <chrono>		//std::chrono::steady_clock
+#include <cstdio>		//std::printf
+#include <cstdlib>		//std::strtoul
+#include <memory>		//std::unique_ptr
+#include <string>		//std::string
+#include <vector>		//std::vector
+
+//what the game compared words with before the kernels -- toupper on each letter
+static bool reference(std::string_view lhs, std::string_view rhs) {
+	if (lhs.size() != rhs.size())
+		return false;
+	for (std::size_t i = 0; i < lhs.size(); ++i)
+	{
+		if (std::toupper(static_cast<unsigned char>(lhs[i])) != std::toupper(static_cast<unsigned char>(rhs[i])))
+			return false;
+	}
+	return true;
+}
+
+//bytes either side of the letters, where a careless fold goes wrong
+static const char edges[] = { '@', 'A', 'Z', '[', '`', 'a', 'z', '{', '\0', '\x7F', '\x80', '\xC1', '\xE1', '\xFF' };
+
+static char random_byte(rng& gen) {
+	if (gen.bounded(4) == 0)
+		return edges[gen.bounded(sizeof(edges))];
+	return static_cast<char>('a' + gen.bounded(26));
+}
+
+//word held in a buffer of exactly its size
+struct exact_word {
+	std::unique_ptr<char[]> data;
+	std::size_t size;
+
+	explicit exact_word(const std::string& s) : data(new char[s.size() ? s.size() : 1]), size(s.size()) {
+		s.copy(data.get(), s.size());
+	}
+	std::string_view view() const { return std::string_view(data.get(), size); }
+};
+
+//pairs of every length up to 69, mostly equal but for case, some a byte apart, some different lengths
+static unsigned long check(unsigned long pairs, rng& gen) {
+	unsigned long wrong = 0;
+	for (unsigned long p = 0; p < pairs; ++p)
+	{
+		const std::size_t len = static_cast<std::size_t>(gen.bounded(70));
+		std::string a(len, ' ');
+		for (char& c : a)
+			c = random_byte(gen);
+		std::string b = a;
+		for (char& c : b)
+		{
+			if (gen.bounded(2) == 0)
+				c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+		}
+		const unsigned int change = static_cast<unsigned int>(gen.bounded(4));
+		if (change == 1 && len > 0)
+			b[gen.bounded(len)] = random_byte(gen);
+		else if (change == 2)
+			b.push_back(random_byte(gen));
+
+		const exact_word l(a), r(b);
+		const bool want = reference(l.view(), r.view());
+		if (ascii_iequal(l.view(), r.view()) != want)
+		{
+			if (++wrong <= 5)
+				std::printf("mismatch: \"%s\" vs \"%s\"\n", a.c_str(), b.c_str());
+		}
+	}
+	return wrong;
+}
+
+//ns per compare of equal pairs of length len, case shuffled -- fastest of rounds
+template <typename Compare>
+static double time_length(std::size_t len, unsigned long rounds, rng& gen, Compare compare) {
+	const std::size_t PAIRS = 1024;
+	std::vector<std::string> lhs, rhs;
+	for (std::size_t p = 0; p < PAIRS; ++p)
+	{
+		std::string a(len, ' ');
+		for (char& c : a)
+			c = static_cast<char>('a' + gen.bounded(26));
+		std::string b = a;
+		for (char& c : b)
+		{
+			if (gen.bounded(2) == 0)
+				c = static_cast<char>(c - ('a' - 'A'));
+		}
+		lhs.push_back(a);
+		rhs.push_back(b);
+	}
+
+	double best = 0;
+	volatile std::size_t sink = 0;
+	for (unsigned long round = 0; round < rounds; ++round)
+	{
+		std::chrono::steady_clock::time_point start_t = std::chrono::steady_clock::now();
+		std::size_t equal = 0;
+		for (int rep = 0; rep < 200; ++rep)
+		{
+			for (std::size_t p = 0; p < PAIRS; ++p)
+				equal += compare(std::string_view(lhs[p]), std::string_view(rhs[p]));
+		}
+		const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_t).count();
+		sink = sink + equal;
+		const double ns = secs * 1e9 / (200.0 * PAIRS);
+		if (round == 0 || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned long pairs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+	const unsigned long rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+	rng gen(1);
+
+	std::printf("kernel: %s\n", ascii_kernel_name());
+	const unsigned long wrong = check(pairs, gen);
+	std::printf("%lu random pairs, %lu mismatches\n", pairs, wrong);
+
+	std::printf("ns per compare, equal but for case:\n   len  toupper  kernel\n");
+	const std::size_t lengths[] = { 3, 5, 8, 10, 15, 20, 30, 64 };
+	for (std::size_t len : lengths)
+	{
+		const double before = time_length(len, rounds, gen, reference);
+		const double after = time_length(len, rounds, gen, ascii_iequal);
+		std::printf("%6zu %8.1f %7.1f\n", len, before, after);
+	}
+	return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,382 @@
+/*
+* Justin W Li
+* coro_engine.cpp
+* coroutine turn engine function implementations
+*/
+
+#include "coro_engine.h"
+
+#ifdef GOBLINS_COROUTINES
+
+#include <algorithm>	//std::max
+
+//-----------------------------------
+//----FRAME ARENA IMPLEMENTATIONS----
+//-----------------------------------
+
+const std::size_t coro_engine::frame_arena::BLOCK_SIZE;	//std::max takes it by reference
+
+//frames are rounded up to keep the next one aligned; one too big for a block gets a block of its own
+void* coro_engine::frame_arena::allocate(std::size_t size) {
+	const std::size_t ALIGN = alignof(std::max_align_t);
+	size = (size + ALIGN - 1) & ~(ALIGN - 1);
+	while (block < blocks.size() && used + size > sizes[block])
+	{
+		++block;
+		used = 0;
+	}
+	if (block == blocks.size())
+	{
+		const std::size_t bytes = std::max(BLOCK_SIZE, size);
+		blocks.emplace_back(new unsigned char[bytes]);
+		sizes.push_back(bytes);
+		used = 0;
+	}
+	void* frame = blocks[block].get() + used;
+	used += size;
+	return frame;
+}
+
+//------------------------------
+//----DRIVER IMPLEMENTATIONS----
+//------------------------------
+
+//ctor
+coro_engine::coro_engine(const event_engine::context& ctx_) : ctx(ctx_), frames(), req(), turns(0) {
+	if (ctx.rh == nullptr || ctx.wh == nullptr || ctx.enh == nullptr || ctx.p == nullptr || ctx.io == nullptr)
+		throw "coro_engine(): invalid handler pointer!\n";
+}
+
+coro_engine::input coro_engine::read_word(std::string& typed, std::string_view word,
+	std::chrono::steady_clock::time_point deadline) {
+	req.kind = request::WORD;
+	req.typed = &typed;
+	req.pass = word;
+	req.deadline = deadline;
+	return input{ this };
+}
+
+coro_engine::input coro_engine::read_choice(std::string& typed, std::string_view pass, std::string_view fail) {
+	req.kind = request::CHOICE;
+	req.typed = &typed;
+	req.pass = pass;
+	req.fail = fail;
+	return input{ this };
+}
+
+coro_engine::input coro_engine::wait_enter() {
+	req.kind = request::ENTER;
+	return input{ this };
+}
+
+//each resume runs turn on to its next wait for input, through however many steps that takes
+void coro_engine::drive(std::coroutine_handle<> top) {
+	std::coroutine_handle<> next = top;
+	for (;;)
+	{
+		req.waiter = nullptr;
+		next.resume();
+		if (top.done())
+			return;
+
+		game_io& io = *ctx.io;
+		switch (req.kind)
+		{
+		case request::WORD:
+			io.read_word(*req.typed, req.pass, req.deadline);
+			break;
+		case request::CHOICE:
+			io.read_choice(*req.typed, req.pass, req.fail);
+			break;
+		case request::ENTER:
+			io.wait_enter();
+			break;
+		}
+		next = req.waiter;
+	}
+}
+
+//the other engines run the intro as part of the first turn, so quitting in it still counts that turn
+bool coro_engine::run_intro() {
+	bool started;
+	{
+		task<bool> t = intro();
+		drive(t.h);
+		started = t.h.promise().result();
+	}
+	frames.reset();
+	if (!started)
+		++turns;
+	return started;
+}
+
+void coro_engine::run_turn(bool spawn, bool fight) {
+	{
+		task<void> t = turn(spawn, fight);
+		drive(t.h);
+	}
+	frames.reset();
+	++turns;
+}
+
+//----------------------------
+//----TURN IMPLEMENTATIONS----
+//----------------------------
+
+coro_engine::task<bool> coro_engine::intro() {
+	game_io& io = *ctx.io;
+	io.out() << "Welcome to Goblins! Prepare to go from room to room in a dungeon." << std::endl;
+	io.out() << "In each room, goblins will line up to fight you, one at a time." << std::endl;
+	io.out() << "Attack the goblins and dodge their attacks by quickly typing in the words they throw at you!" << std::endl;
+	io.out() << "Be warned that if you either spell the word wrong or fail to type it in time," << std::endl;
+	io.out() << "you will either miss your attack or get hit by that of goblin's. It's not case-sensitive, though." << std::endl;
+	io.out() << "You'll move to the next room once there are no goblins left in line." << std::endl;
+	io.out() << std::endl;
+
+	if (!co_await choice("Start", "Quit"))
+	{
+		player_quit();
+		co_return false;
+	}
+	io.out() << "You walk into the dungeon. It smells like goblin in here!" << std::endl;
+	io.out() << std::endl;
+	co_return true;
+}
+
+//same steps, in the same order, as the events run_flat queues for a turn: the player's attack and everything it
+//leads to, then the enemy's, then the spawn, then the room's bookkeeping
+coro_engine::task<void> coro_engine::turn(bool spawn, bool fight) {
+	game_io& io = *ctx.io;
+	bool room_done = false;
+
+	if (fight)
+	{
+		//player attacks -- and the enemy strikes once its patience runs out, so the player's word is cut short there
+		io.out() << "Attack the " << ctx.enh->curr_name() << "!" << std::endl;
+		io.out() << "Press enter to start combat." << std::endl;
+		co_await wait_enter();
+		strike s = co_await combat(ctx.enh->patience());
+		if (s.passed || s.near > 0)
+			enemy_defend(s.passed ? 1.0 : s.near, room_done);
+		else
+			io.out() << "You missed!" << std::endl;
+
+		//enemy attacks, if one is left
+		if (!ctx.enh->empty())
+		{
+			io.out() << "The " << ctx.enh->curr_name() << " is attacking!" << std::endl;
+			int dmg = ctx.enh->attack();
+			io.out() << "Press enter to start combat." << std::endl;
+			co_await wait_enter();
+			s = co_await combat(0);
+			if (s.passed)
+			{
+				io.out() << "You dodged the attack!" << std::endl;
+				ctx.rh->playerDodge();
+			}
+			else
+			{
+				//the better the attempt, the less of the hit lands
+				if (s.near > 0)
+					dmg = static_cast<int>(dmg * (1.0 - s.near) + 0.5);
+				if (player_defend(dmg, s.near > 0))
+				{
+					io.out() << "You died. Would you like to continue?" << std::endl;
+					ctx.rh->playerDie();
+					if (!co_await choice("Yes", "No"))
+					{
+						player_quit();
+						co_return;
+					}
+					player_continue();
+				}
+			}
+		}
+	}
+
+	if (spawn)
+	{
+		ctx.enh->spawn();
+		io.out() << "A " << ctx.enh->last_name() << " just got in line!" << std::endl;
+		io.out() << "HP: " << ctx.enh->hp_back() << ", " << "ATK: " << ctx.enh->attack_back() << std::endl;
+
+		int gobs_left = ctx.enh->enemies_left();
+		if (gobs_left != 1)
+			io.out() << "There are now " << gobs_left << " goblins in line." << std::endl;
+		else
+			io.out() << "There is now " << gobs_left << " goblin in line." << std::endl; //singular
+		ctx.rh->enemySpawn();
+	}
+
+	ctx.rh->turnOver();
+
+	if (room_done)
+	{
+		io.out() << "There are no more goblins in the room. You go and step into the next room." << std::endl;
+		ctx.rh->room_over();							//evaluate player performance
+		ctx.enh->set_stage(ctx.rh->get_performance());	//update stage
+		ctx.enh->set_thresholds();						//update thresholds
+		io.out() << "Press enter to continue." << std::endl;
+		co_await wait_enter();
+		ctx.rh->room_over();							//room_over event notifies room_handler as well
+	}
+}
+
+coro_engine::task<coro_engine::strike> coro_engine::combat(int patience) {
+	game_io& io = *ctx.io;
+	//time that player started typing
+	std::chrono::steady_clock::time_point start_t = io.now();
+
+	//generate a string based on the type
+	const word_handler::held_word word = ctx.wh->get_string(ctx.enh->get_type());	//keeps word valid through a reload
+	std::string_view str = word;
+
+	std::string& user_str = io.typing();
+	io.out() << "Type \"" << str << "\"." << std::endl;
+	unsigned int limit_t = static_cast<unsigned int>(str.size() * 250 + 1500); //250 milliseconds per letter, plus 1.5 seconds to read
+	//the enemy's clock starts once the word is shown -- its strike cuts the word short
+	const std::chrono::steady_clock::time_point strike_t = patience != 0 ?
+		start_t + std::chrono::milliseconds(patience) : std::chrono::steady_clock::time_point::max();
+	const bool cut = strike_t < start_t + std::chrono::milliseconds(limit_t);
+	if (cut)
+		limit_t = strike_t > start_t ? static_cast<unsigned int>(
+			std::chrono::duration_cast<std::chrono::milliseconds>(strike_t - start_t).count()) : 0;
+	co_await read_word(user_str, str, start_t + std::chrono::milliseconds(limit_t));
+
+	unsigned int wait_t = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+		io.now() - start_t).count());
+	strike s = { wait_t < limit_t && ctx.wh->string_compare(str, user_str), 0.0 };
+	if (cut && wait_t >= limit_t)
+		io.out() << "The " << ctx.enh->curr_name() << " strikes before you finish!" << std::endl;
+
+	//in graded mode, a near miss in time gives partial credit
+	if (!s.passed && wait_t < limit_t && ctx.wh->is_graded())
+	{
+		double acc = ctx.wh->accuracy(str, user_str);
+		if (acc >= combat_event::NEAR_MISS)
+			s.near = acc;
+	}
+
+	co_await wait_enter();
+	io.out() << std::endl;
+	co_return s;
+}
+
+coro_engine::task<bool> coro_engine::choice(const char* pass, const char* fail) {
+	game_io& io = *ctx.io;
+	std::string user_str;
+	std::size_t match;
+	do {
+		//prompt user for string until entry matches either pass string or fail string
+		io.out() << "Type \"" << pass << "\" or \"" << fail << "\"." << std::endl;
+		co_await read_choice(user_str, pass, fail);
+		const std::string_view options[2] = { pass, fail };
+		match = ctx.wh->string_match(user_str, options, 2);
+
+		if (match == 2)
+		{
+			//input matches neither; prompt user to try again
+			io.out() << "Sorry, input was not recognized. Please try again." << std::endl;
+		}
+
+	} while (match == 2);
+
+	co_await wait_enter();
+	io.out() << std::endl;
+	co_return match == 0;
+}
+
+//--------------------------------
+//----FEEDBACK IMPLEMENTATIONS----
+//--------------------------------
+
+void coro_engine::enemy_defend(double accuracy, bool& room_done) {
+	game_io& io = *ctx.io;
+	//a glancing blow still does at least 1 damage
+	int dmg = ctx.p->attack();
+	if (accuracy < 1.0)
+	{
+		dmg = std::max(1, static_cast<int>(dmg * accuracy + 0.5));
+		io.out() << "A glancing blow!" << std::endl;
+	}
+
+	io.out() << "The " << ctx.enh->curr_name() << " takes " << dmg << " damage!" << std::endl;
+	ctx.enh->defend(dmg);
+
+	bool dead = !ctx.enh->alive();
+	if (!dead)
+		io.out() << "It still has " << ctx.enh->hp() << " hp." << std::endl;
+	ctx.rh->playerAttack();
+	if (dead)
+		enemy_die(room_done);
+}
+
+void coro_engine::enemy_die(bool& room_done) {
+	game_io& io = *ctx.io;
+	io.out() << "The " << ctx.enh->curr_name() << " is dead!" << std::endl;
+	const int exp = ctx.enh->exp();
+
+	//kill enemy
+	ctx.enh->die();
+
+	int gobs_left = ctx.enh->enemies_left();
+	if (gobs_left)
+	{
+		//enemy at front of new line is different; notify player
+		io.out() << "A " << ctx.enh->curr_name() << " steps up to take its place." << std::endl;
+		if (gobs_left != 1)
+			io.out() << "There are " << gobs_left << " goblins left in line." << std::endl;
+		else
+			io.out() << "There is " << gobs_left << " goblin left in line." << std::endl; //singular
+	}
+	else
+		room_done = true;	//room is over once the turn is
+	ctx.rh->enemyDie();
+	player_exp(exp);
+}
+
+void coro_engine::player_exp(int exp) {
+	game_io& io = *ctx.io;
+	io.out() << "You gained " << exp << " EXP!" << std::endl;
+	ctx.p->gain_exp(exp);
+
+	//check that player has leveled up
+	if (ctx.p->can_level())
+		player_levelup();
+}
+
+void coro_engine::player_levelup() {
+	game_io& io = *ctx.io;
+	io.out() << "You leveled up!" << std::endl;
+	ctx.p->level_up();
+	ctx.p->print_stats(io.out());
+}
+
+bool coro_engine::player_defend(int dmg, bool grazed) {
+	game_io& io = *ctx.io;
+	if (grazed)
+		io.out() << "You partly dodged the attack." << std::endl;
+	io.out() << "You got hit and took " << dmg << " damage." << std::endl;
+	ctx.p->defend(dmg);
+	if (!ctx.p->alive())
+		return true;
+	io.out() << "You still have " << ctx.p->health() << " hp." << std::endl;
+	return false;
+}
+
+void coro_engine::player_continue() {
+	game_io& io = *ctx.io;
+	//restart the room, but keep most metrics
+	io.out() << "Reseting the room." << std::endl;
+	ctx.p->fully_heal();
+	ctx.rh->reset();
+	ctx.enh->kill_all();
+}
+
+void coro_engine::player_quit() {
+	game_io& io = *ctx.io;
+	io.out() << "Thanks for playing!" << std::endl;
+	ctx.p->game_over();		//ensure hp is zero; player is dead
+}
+
+#endif
@@ -0,0 +1,197 @@
+/*
+* Justin W Li
+* coro_engine.h
+* coroutine turn engine class definition
+* needs C++20 -- built only where the compiler has coroutines, which GOBLINS_COROUTINES is defined for
+*/
+
+#ifndef CORO_ENGINE_H
+#define CORO_ENGINE_H
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define GOBLINS_COROUTINES
+
+#include "event_engine.h"
+
+#include <chrono>		//std::chrono::steady_clock
+#include <coroutine>	//std::coroutine_handle, std::suspend_always, std::noop_coroutine
+#include <cstddef>		//std::size_t, std::max_align_t
+#include <cstdint>		//std::uint64_t
+#include <memory>		//std::unique_ptr
+#include <string>		//std::string
+#include <string_view>	//std::string_view
+#include <vector>		//std::vector
+
+//-------------------------
+//----CORO ENGINE CLASS----
+//-------------------------
+
+//runs the same game as event_handler and event_engine, with each turn one coroutine rather than a chain of events
+//a turn reads top to bottom in the order the event engines run it, and co_awaits the player wherever they would wait
+//on input -- the engine does the reading, through game_io, and resumes the turn with what was typed
+//every coroutine frame of a turn comes out of one arena, reset once the turn is over, so turns cost no allocations
+class coro_engine {
+	//frames of the running turn, carved one after another out of blocks kept from turn to turn
+	class frame_arena {
+		static const std::size_t BLOCK_SIZE = 4096;
+
+		std::vector<std::unique_ptr<unsigned char[]>> blocks;
+		std::vector<std::size_t> sizes;					//bytes in each block
+		std::size_t block;								//block frames are carved from
+		std::size_t used;								//bytes of it carved so far
+
+	public:
+		frame_arena() : blocks(), sizes(), block(0), used(0) {}
+		void* allocate(std::size_t size);
+		void reset() { block = used = 0; }				//every frame is gone -- carve from the start again
+	};
+
+public:
+	//coroutine handing back a T once awaited -- starts when awaited, and resumes its awaiter when done
+	template<class T>
+	class task;
+
+private:
+	//what the turn is waiting on the player for
+	struct request {
+		enum kind_t { WORD, CHOICE, ENTER };
+		kind_t kind;
+		std::string* typed;
+		std::string_view pass;							//word to type -- or for a choice, the word to accept
+		std::string_view fail;
+		std::chrono::steady_clock::time_point deadline;
+		std::coroutine_handle<> waiter;					//frame to resume once it is read
+	};
+
+	//suspends the turn until the engine has read what req asks for
+	struct input {
+		coro_engine* eng;
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> h) noexcept { eng->req.waiter = h; }
+		void await_resume() const noexcept {}
+	};
+
+	//how the player did on a word
+	struct strike {
+		bool passed;
+		double near;									//accuracy of a near miss that earns partial credit; 0 if none
+	};
+
+	friend struct coro_promise_base;
+
+	event_engine::context ctx;
+	frame_arena frames;
+	request req;
+	std::uint64_t turns;								//turns run so far
+
+	input read_word(std::string& typed, std::string_view word, std::chrono::steady_clock::time_point deadline);
+	input read_choice(std::string& typed, std::string_view pass, std::string_view fail);
+	input wait_enter();
+	void drive(std::coroutine_handle<> top);			//resumes turn and reads for it until it is done
+
+	//steps of a turn that wait on the player
+	task<bool> intro();									//false if player quits
+	task<void> turn(bool spawn, bool fight);
+	task<strike> combat(int patience);					//word is cut short patience ms after it is shown; 0 never
+	task<bool> choice(const char* pass, const char* fail);	//true if player types pass
+
+	//steps that do not -- each does what the event of the same name does
+	void enemy_defend(double accuracy, bool& room_done);	//room_done is set if last enemy of room dies
+	void enemy_die(bool& room_done);
+	void player_exp(int exp);
+	void player_levelup();
+	bool player_defend(int dmg, bool grazed);			//true if player died
+	void player_continue();
+	void player_quit();
+
+public:
+	explicit coro_engine(const event_engine::context& ctx_);
+
+	bool run_intro();									//plays game's intro; false if player quit in it
+	void run_turn(bool spawn, bool fight);				//plays one turn -- what run_flat queues each time round
+	std::uint64_t turns_run() const { return turns; }
+	void set_io(game_io& io_) { ctx.io = &io_; }
+};
+
+//------------------
+//----TASK CLASS----
+//------------------
+
+//promise parts every task shares
+//frames are only made through the engine's arena -- operator new takes the coro_engine a member coroutine is called on,
+//so a coroutine that is not a member of coro_engine does not compile as a task
+struct coro_promise_base {
+	std::coroutine_handle<> continuation;				//awaiter to resume once done
+
+	//resumes awaiter, or if none, hands control back to coro_engine::drive
+	struct final_awaiter {
+		bool await_ready() const noexcept { return false; }
+		template<class P>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept {
+			std::coroutine_handle<> next = h.promise().continuation;
+			return next ? next : std::noop_coroutine();
+		}
+		void await_resume() const noexcept {}
+	};
+
+	std::suspend_always initial_suspend() const noexcept { return {}; }
+	final_awaiter final_suspend() const noexcept { return {}; }
+	void unhandled_exception() { throw; }				//on to whoever resumed the turn
+
+	template<class... Args>
+	static void* operator new(std::size_t size, coro_engine& eng, const Args&...);
+	static void operator delete(void*, std::size_t) noexcept {}	//arena is reset once the turn is over
+};
+
+template<class T>
+struct coro_promise : coro_promise_base {
+	T value;
+	void return_value(const T& value_) { value = value_; }
+	T result() { return value; }
+};
+
+template<>
+struct coro_promise<void> : coro_promise_base {
+	void return_void() const noexcept {}
+	void result() const noexcept {}
+};
+
+template<class... Args>
+void* coro_promise_base::operator new(std::size_t size, coro_engine& eng, const Args&...) {
+	return eng.frames.allocate(size);
+}
+
+template<class T>
+class coro_engine::task {
+public:
+	struct promise_type : coro_promise<T> {
+		task get_return_object() { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+	};
+
+private:
+	std::coroutine_handle<promise_type> h;
+
+	explicit task(std::coroutine_handle<promise_type> h_) : h(h_) {}
+	friend class coro_engine;
+
+public:
+	task(task&& o) noexcept : h(o.h) { o.h = nullptr; }
+	task(const task&) = delete;
+	task& operator=(const task&) = delete;
+	~task() {
+		if (h)
+			h.destroy();
+	}
+
+	//awaiting a task runs it straight away, in place of its awaiter
+	bool await_ready() const noexcept { return false; }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		h.promise().continuation = awaiter;
+		return h;
+	}
+	T await_resume() { return h.promise().result(); }
+};
+
+#endif
+
+#endif
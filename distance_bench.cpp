@@ -0,0 +1,147 @@
+/*
+* Justin W Li
+* distance_bench.cpp
+* checks edit_distance against a plain dynamic programming table, and times it beside the exact match
+* usage: distance_bench [pairs] [rounds]
+*	pairs -- random pairs checked against the table (default 300000)
+*	rounds -- passes timed over each length; the fastest is reported (default 5)
+* exits with 1 if edit_distance and the table disagree on any pair
+*/
+
+#include "ascii_compare.h"
+#include "edit_distance.h"
+#include "rng.h"
+
+#include <algorithm>	//std::min
+#include <cctype>		//std::toupper
+#include <chrono>		//std::chrono::steady_clock
+#include <cstdio>		//std::printf
+#include <cstdlib>		//std::strtoul
+#include <string>		//std::string
+#include <vector>		//std::vector
+
+//optimal string alignment distance, straight from its definition -- whole table, no tricks
+static std::size_t reference(const std::string& a, const std::string& b) {
+	auto same = [](char x, char y) {
+		return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+	};
+	std::vector<std::vector<std::size_t>> d(a.size() + 1, std::vector<std::size_t>(b.size() + 1));
+	for (std::size_t i = 0; i <= a.size(); ++i)
+		d[i][0] = i;
+	for (std::size_t j = 0; j <= b.size(); ++j)
+		d[0][j] = j;
+	for (std::size_t i = 1; i <= a.size(); ++i)
+	{
+		for (std::size_t j = 1; j <= b.size(); ++j)
+		{
+			d[i][j] = std::min({ d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (same(a[i - 1], b[j - 1]) ? 0 : 1) });
+			if (i > 1 && j > 1 && same(a[i - 1], b[j - 2]) && same(a[i - 2], b[j - 1]))
+				d[i][j] = std::min(d[i][j], d[i - 2][j - 2] + 1);
+		}
+	}
+	return d[a.size()][b.size()];
+}
+
+//typo made by hand -- a letter changed, dropped, doubled, or swapped with the next
+static void typo(std::string& s, rng& gen) {
+	if (s.empty())
+		return;
+	const std::size_t at = static_cast<std::size_t>(gen.bounded(s.size()));
+	switch (gen.bounded(4))
+	{
+	case 0: s[at] = static_cast<char>('a' + gen.bounded(26)); break;
+	case 1: s.erase(at, 1); break;
+	case 2: s.insert(at, 1, s[at]); break;
+	default: if (at + 1 < s.size()) std::swap(s[at], s[at + 1]); break;
+	}
+}
+
+//pairs of lengths 0 to 89 from a small alphabet, so letters repeat and swaps line up -- a few typos apart,
+//or unrelated; past 64 letters, the table takes over from the bit vectors
+static unsigned long check(unsigned long pairs, rng& gen) {
+	unsigned long wrong = 0;
+	for (unsigned long p = 0; p < pairs; ++p)
+	{
+		std::string a(static_cast<std::size_t>(gen.bounded(90)), ' ');
+		for (char& c : a)
+			c = static_cast<char>((gen.bounded(2) ? 'a' : 'A') + gen.bounded(6));
+		std::string b;
+		if (gen.bounded(4) == 0)
+		{
+			b.resize(static_cast<std::size_t>(gen.bounded(90)));
+			for (char& c : b)
+				c = static_cast<char>('a' + gen.bounded(6));
+		}
+		else
+		{
+			b = a;
+			for (std::uint64_t n = gen.bounded(4); n > 0; --n)
+				typo(b, gen);
+		}
+
+		const std::size_t want = reference(a, b);
+		if (edit_distance(a, b) != want || edit_distance(b, a) != want)
+		{
+			if (++wrong <= 5)
+				std::printf("mismatch: \"%s\" vs \"%s\" -- want %zu, got %zu\n", a.c_str(), b.c_str(), want,
+					edit_distance(a, b));
+		}
+	}
+	return wrong;
+}
+
+//ns per call over pairs of length len, one typo apart -- fastest of rounds
+template <typename Check>
+static double time_length(std::size_t len, unsigned long rounds, rng& gen, Check check) {
+	const std::size_t PAIRS = 1024;
+	std::vector<std::string> target, typed;
+	for (std::size_t p = 0; p < PAIRS; ++p)
+	{
+		std::string a(len, ' ');
+		for (char& c : a)
+			c = static_cast<char>('a' + gen.bounded(26));
+		std::string b = a;
+		typo(b, gen);
+		target.push_back(a);
+		typed.push_back(b);
+	}
+
+	double best = 0;
+	volatile std::size_t sink = 0;
+	for (unsigned long round = 0; round < rounds; ++round)
+	{
+		std::chrono::steady_clock::time_point start_t = std::chrono::steady_clock::now();
+		std::size_t total = 0;
+		for (int rep = 0; rep < 100; ++rep)
+		{
+			for (std::size_t p = 0; p < PAIRS; ++p)
+				total += check(std::string_view(target[p]), std::string_view(typed[p]));
+		}
+		const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_t).count();
+		sink = sink + total;
+		const double ns = secs * 1e9 / (100.0 * PAIRS);
+		if (round == 0 || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned long pairs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300000;
+	const unsigned long rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+	rng gen(1);
+
+	const unsigned long wrong = check(pairs, gen);
+	std::printf("%lu random pairs, %lu mismatches\n", pairs, wrong);
+
+	std::printf("ns per check, one typo apart:\n   len   exact  distance\n");
+	const std::size_t lengths[] = { 3, 5, 8, 10, 15, 20, 30, 64 };
+	for (std::size_t len : lengths)
+	{
+		const double exact = time_length(len, rounds, gen, ascii_iequal);
+		const double distance = time_length(len, rounds, gen, edit_distance);
+		std::printf("%6zu %7.1f %9.1f\n", len, exact, distance);
+	}
+	return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+/*
+* Justin W Li
+* edit_distance.cpp
+* case-insensitive damerau-levenshtein distance implementations
+*/
+
+#include "edit_distance.h"
+#include <algorithm>    //std::min
+#include <cstdint>      //std::uint64_t
+#include <vector>       //std::vector
+
+//upper case of an ascii letter; other bytes are left alone
+static inline unsigned char fold(char c) {
+	unsigned char u = static_cast<unsigned char>(c);
+	return (static_cast<unsigned int>(u - 'a') < 26u) ? static_cast<unsigned char>(u - ('a' - 'A')) : u;
+}
+
+//set bits of v
+static inline std::size_t popcount(std::uint64_t v) {
+	v = v - ((v >> 1) & 0x5555555555555555ull);
+	v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+	v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<std::size_t>((v * 0x0101010101010101ull) >> 56);
+}
+
+//hyyro's bit-vector algorithm, with his adjacent-swap extension -- pattern must be 1 to 64 letters
+//each bit of the vectors tracks one row of the distance table; one text letter advances every row at once
+//the loop only carries the vectors, the dependency chain that sets its pace -- the distance is read off the last
+//column once at the end
+static std::size_t distance_bits(std::string_view pattern, std::string_view text) {
+	//bitmask of positions in pattern holding each letter -- only letters of either word are touched,
+	//so letters of text missing from pattern match nowhere
+	std::uint64_t peq[256];
+	for (char c : pattern)
+		peq[fold(c)] = 0;
+	for (char c : text)
+		peq[fold(c)] = 0;
+	for (std::size_t i = 0; i < pattern.size(); ++i)
+		peq[fold(pattern[i])] |= std::uint64_t(1) << i;
+
+	const std::uint64_t rows = ~std::uint64_t(0) >> (64 - pattern.size());
+	std::uint64_t vp = ~std::uint64_t(0), vn = 0, d0 = 0, prev_eq = 0;
+
+	for (char c : text)
+	{
+		const unsigned char t = fold(c);
+		const std::uint64_t eq = peq[t];
+
+		const std::uint64_t swap = ((~d0 & eq) << 1) & prev_eq;
+		d0 = (((eq & vp) + vp) ^ vp) | eq | vn | swap;
+
+		//horizontal steps, moved down a row -- the top row counts up by one per letter of text, so its step is
+		//always up; kept as where hp is clear, which leaves the "| 1" out of the chain
+		const std::uint64_t hn = (d0 & vp) << 1;
+		const std::uint64_t not_hp = (~vn & (d0 | vp)) << 1;
+		vp = hn | (not_hp & ~d0);
+		vn = d0 & ~not_hp;
+		prev_eq = eq;
+	}
+
+	//bottom of last column: top row's value there, plus each row's step down it
+	return text.size() + popcount(vp & rows) - popcount(vn & rows);
+}
+
+//full dynamic programming table, three rows at a time -- only for words too long for a 64-bit vector
+static std::size_t distance_table(std::string_view a, std::string_view b) {
+	std::vector<std::size_t> prev2(b.size() + 1), prev(b.size() + 1), curr(b.size() + 1);
+	for (std::size_t j = 0; j <= b.size(); ++j)
+		prev[j] = j;
+
+	for (std::size_t i = 1; i <= a.size(); ++i)
+	{
+		curr[0] = i;
+		for (std::size_t j = 1; j <= b.size(); ++j)
+		{
+			const std::size_t cost = fold(a[i - 1]) == fold(b[j - 1]) ? 0 : 1;
+			curr[j] = std::min({ prev[j] + 1, curr[j - 1] + 1, prev[j - 1] + cost });
+			if (i > 1 && j > 1 && fold(a[i - 1]) == fold(b[j - 2]) && fold(a[i - 2]) == fold(b[j - 1]))
+				curr[j] = std::min(curr[j], prev2[j - 2] + 1);
+		}
+		prev2.swap(prev);
+		prev.swap(curr);
+	}
+	return prev[b.size()];
+}
+
+std::size_t edit_distance(std::string_view target, std::string_view typed) {
+	if (target.empty())
+		return typed.size();
+	if (typed.empty())
+		return target.size();
+
+	//distance is symmetric, so either word can be the bit-vector pattern
+	if (target.size() <= 64)
+		return distance_bits(target, typed);
+	if (typed.size() <= 64)
+		return distance_bits(typed, target);
+	return distance_table(target, typed);
+}
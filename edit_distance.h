@@ -0,0 +1,18 @@
+/*
+* Justin W Li
+* edit_distance.h
+* case-insensitive damerau-levenshtein distance
+*/
+
+#ifndef EDIT_DISTANCE_H
+#define EDIT_DISTANCE_H
+
+#include <cstddef>		//std::size_t
+#include <string_view>	//std::string_view
+
+//number of insertions, deletions, substitutions and adjacent swaps turning typed into target, ignoring ascii case
+//(optimal string alignment -- each letter is edited at most once)
+//bit-parallel when either word is 64 letters or shorter; falls back to a dynamic programming table otherwise
+std::size_t edit_distance(std::string_view target, std::string_view typed);
+
+#endif
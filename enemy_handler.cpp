@@ -18,30 +18,35 @@ enemy_handler::enemy::enemy(unsigned int type_) : type(type_) {
 		hp = 10;
 		atk = 5;
 		exp = 3;
+		patience = 8000;
 		break;
 	case GOB_SHAMAN:
 		name = "GOB_SHAMAN";
 		hp = 20;
 		atk = 10;
 		exp = 9;
+		patience = 7500;
 		break;
 	case HOBGOBLIN:
 		name = "HOBGOBLIN";
 		hp = 50;
 		atk = 15;
 		exp = 27;
+		patience = 7000;
 		break;
 	case GOB_LORD:
 		name = "GOB_LORD";
 		hp = 100;
 		atk = 45;
 		exp = 81;
+		patience = 6500;
 		break;
 	case GOB_PALADIN:
 		name = "GOB_PALADIN";
 		hp = 200;
 		atk = 100;
 		exp = 243;
+		patience = 6000;
 		break;
 	default:
 		throw "Invalid enemy type inputted!";
@@ -50,8 +55,8 @@ enemy_handler::enemy::enemy(unsigned int type_) : type(type_) {
 }
 
 //enemy handler ctor
-enemy_handler::enemy_handler() : enemies(), stage(0), threshholds() {
-	std::srand(static_cast<unsigned int>(std::time(nullptr)));		//create seed
+enemy_handler::enemy_handler(rng* gen_) : enemies(), fallen(), gen(gen_), stage(0), threshholds(), strikes(false) {
+	if (gen_ == nullptr) throw "enemy_handler(): invalid generator pointer!\n";
 	set_thresholds();												//properly init threshholds
 }
 
@@ -206,12 +211,18 @@ void enemy_handler::set_thresholds() {
 }
 
 void enemy_handler::spawn() {
-	int enemy_type = rand() % 101;	//generate a number between 0 and 100
+	int enemy_type = static_cast<int>(gen->bounded(100));	//generate a number between 0 and 99
 	for (unsigned int i = 0; i < 5; ++i) {	
 		if (enemy_type < threshholds[i]) //find where random number falls in threshholds
 		{
-			//correct enemy type found; spawn and return
-			enemies.push_back(enemy(i));
+			//correct enemy type found; spawn into a fallen enemy's node if there is one, and return
+			if (fallen.empty())
+				enemies.push_back(enemy(i));
+			else
+			{
+				enemies.splice(enemies.end(), fallen, fallen.begin());
+				enemies.back() = enemy(i);
+			}
 			return;
 		}
 	}
@@ -223,11 +234,17 @@ int enemy_handler::attack() const { return enemies.front().atk; }
 int enemy_handler::attack_back() const { return enemies.back().atk; }
 void enemy_handler::defend(int dmg) { enemies.front().hp -= dmg; }
 int enemy_handler::exp() const { return enemies.front().exp; }
+int enemy_handler::patience() const { return strikes ? enemies.front().patience : 0; }
 bool enemy_handler::alive() const { return enemies.front().hp > 0; }
-void enemy_handler::die() { enemies.pop_front(); }
+void enemy_handler::die() { fallen.splice(fallen.begin(), enemies, enemies.begin()); }
 bool enemy_handler::empty() const { return enemies.empty(); }
 unsigned int enemy_handler::get_type() const { return enemies.front().type; }
-void enemy_handler::kill_all() { enemies.clear(); }
+void enemy_handler::kill_all() { fallen.splice(fallen.begin(), enemies); }
+void enemy_handler::reset() {
+	kill_all();
+	stage = 0;
+	set_thresholds();
+}
 void enemy_handler::print_enemies() const {
 	enemy_handler::print p;
 	std::for_each(enemies.begin(), enemies.end(), p);
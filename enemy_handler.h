@@ -7,10 +7,10 @@
 #ifndef ENEMY_HANDLER_H
 #define ENEMY_HANDLER_H
 
+#include "rng.h"
+
 #include <iostream>   //std::cout
 #include <list>       //std::list
-#include <cstdlib>    //rand, srand
-#include <ctime>      //time
 #include <string>     //string
 
 //---------------------------
@@ -26,6 +26,7 @@ class enemy_handler {
 		int hp;						//current health of enemy
 		int atk;					//attack of enemy
 		int exp;			//experience points dropped when killed
+		int patience;				//milliseconds after the player's word is shown that it strikes, finished or not
 
 		//default ctor
 		enemy(unsigned int type_);
@@ -39,8 +40,11 @@ class enemy_handler {
 	};
 
 	std::list<enemy> enemies;							//enemy storage
+	std::list<enemy> fallen;							//nodes of dead enemies, spliced back in by spawn instead of allocating new ones
+	rng* const gen;										//session's random number generator
 	unsigned stage;										//game stage
 	int threshholds[5];									//probability threshholds to spawn each enemy -- used in 
+	bool strikes;										//whether enemies strike once their patience runs out
 
 public:
 
@@ -49,7 +53,7 @@ public:
 
 
 	//ctor
-	enemy_handler();
+	enemy_handler(rng* gen_);
 
 	//combat	
 	int hp() const;								//returns hp of current enemy
@@ -58,6 +62,9 @@ public:
 	int attack_back() const;					//returns attack of enemy at back of line
 	void defend(int dmg);						//subtracts inputted damage from current enemy's health
 	int exp() const;					//returns exp from killing current enemy
+	int patience() const;						//returns milliseconds current enemy waits before it strikes; 0 if
+												//strikes are off, and it waits for the player
+	void set_strikes(bool strikes_) { strikes = strikes_; }	//turns timed strikes on or off -- off by default
 	unsigned int get_type() const;				//gets enemy type
 
 	//enemy rotation/management
@@ -69,6 +76,8 @@ public:
 	bool empty() const;							//returns bool regarding if list is empty or not
 	void print_enemies() const;					//prints out counts of all enemies
 	void kill_all();							//clears enemy queue
+	void reset();								//clears enemy queue and goes back to first stage
+	unsigned get_stage() const { return stage; }	//returns game stage
 	std::string curr_name() const;				//gets name of enemy at front of list
 	std::string last_name() const;				//gets name of enemy at end of list
 	int enemies_left() const;					//returns number of enemies left in list
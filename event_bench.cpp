@@ -0,0 +1,107 @@
+/*
+* Justin W Li
+* event_bench.cpp
+* plays the same scripted session on every engine and times them
+* built as C++20, the coroutine engine is timed too
+* usage: event_bench [words] [seed] [rounds]
+*	words -- words the scripted player types before it starts losing on purpose (default 2000)
+*	seed -- session seed, so every engine sees the same words and spawns (default 1)
+*	rounds -- sessions timed on each engine; the fastest is reported (default 3)
+*/
+
+#include "game_loop.h"
+#include "game_io.h"
+#include <chrono>		//std::chrono::steady_clock
+#include <cstdio>		//std::printf, std::snprintf, std::fputs
+#include <cstdlib>		//std::strtoul, std::strtoull
+#include <string>		//std::string
+
+//script typing two of every three words right, so hits, misses, kills and level ups all come up
+//-- after words of it, the player stops typing, and dies and quits
+static std::string make_script(unsigned long words) {
+	std::string script;
+	for (unsigned long i = 1; i <= words; ++i)
+		script += (i % 3 == 0) ? "zz " : "* ";
+	return script;
+}
+
+//engines timed, in the order they take turns
+enum engine_t { VIRTUAL, FLAT, CORO, ENGINES };
+
+//plays one session; returns seconds it took, and sets turns and events to how many ran
+static double play(int engine, std::uint64_t seed, const std::string& script, std::uint64_t& turns,
+	std::uint64_t& events) {
+	game_loop gl(seed);
+	gl.wait_words();						//loading is not part of what is timed
+
+	scripted_io io(script);					//prints nothing
+	gl.set_io(io);
+
+	std::chrono::steady_clock::time_point start_t = std::chrono::steady_clock::now();
+	if (engine == FLAT)
+		gl.run_flat();
+#ifdef GOBLINS_COROUTINES
+	else if (engine == CORO)
+		gl.run_coro();
+#endif
+	else
+		gl.run();
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_t).count();
+
+	turns = gl.turns_run();
+	events = gl.events_run();
+	return secs;
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned long words = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+	const std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+	const unsigned long rounds = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 3;
+
+	try {
+		const std::string script = make_script(words);
+		const char* names[ENGINES] = { "virtual (event_handler)", "flat (event_engine)", "coroutine (coro_engine)" };
+#ifdef GOBLINS_COROUTINES
+		const int engines = ENGINES;
+#else
+		const int engines = CORO;
+#endif
+		double best[ENGINES] = { 0, 0, 0 };
+		std::uint64_t turns[ENGINES] = { 0, 0, 0 };
+		std::uint64_t events[ENGINES] = { 0, 0, 0 };
+		for (unsigned long r = 0; r < rounds; ++r)
+		{
+			//take turns, so no engine always runs on a warmer machine
+			for (int engine = 0; engine < engines; ++engine)
+			{
+				double secs = play(engine, seed, script, turns[engine], events[engine]);
+				if (r == 0 || secs < best[engine])
+					best[engine] = secs;
+			}
+		}
+
+		//coroutine engine runs no events -- its turns are what compare, and its events are left blank
+		for (int engine = 0; engine < engines; ++engine)
+		{
+			char event_count[24] = "-", event_rate[24] = "-";
+			if (engine != CORO)
+			{
+				std::snprintf(event_count, sizeof(event_count), "%llu", static_cast<unsigned long long>(events[engine]));
+				std::snprintf(event_rate, sizeof(event_rate), "%.0f", events[engine] / best[engine]);
+			}
+			std::printf("%-24s %6llu turns  %8s events  %8.2f ms  %10.0f turns/s  %10s events/s\n", names[engine],
+				static_cast<unsigned long long>(turns[engine]), event_count, best[engine] * 1000,
+				turns[engine] / best[engine], event_rate);
+		}
+		if (events[VIRTUAL] != events[FLAT])
+			std::printf("engines ran different numbers of events!\n");
+		if (turns[FLAT] != turns[VIRTUAL] || (engines == ENGINES && turns[CORO] != turns[VIRTUAL]))
+			std::printf("engines played different numbers of turns!\n");
+	}
+	catch (const char* e) {
+		std::fputs(e, stderr);
+		return 1;
+	}
+	return 0;
+}
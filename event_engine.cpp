@@ -0,0 +1,372 @@
+/*
+* Justin W Li
+* event_engine.cpp
+* flat event engine function implementations
+*/
+
+#include "event_engine.h"
+#include <algorithm>	//std::max
+#include <chrono>		//std::chrono::steady_clock
+#include <string>		//std::string
+#include <utility>		//std::move
+
+//-----------------------------
+//----QUEUE IMPLEMENTATIONS----
+//-----------------------------
+
+//ctor
+event_engine::event_engine(const context& ctx_) : ctx(ctx_), levels(), waiting(0), ran(0) {
+	if (ctx.rh == nullptr || ctx.wh == nullptr || ctx.enh == nullptr || ctx.p == nullptr || ctx.io == nullptr)
+		throw "event_engine(): invalid handler pointer!\n";
+}
+
+//adds event to back of its priority's fifo, so events of equal priority run in the order they were added
+void event_engine::push(int prio, const event& e) {
+	level& l = levels[prio];
+	if (l.count == l.ring.size())
+	{
+		//full -- unroll into a ring twice as large
+		std::vector<event> bigger(std::max<std::size_t>(4, l.ring.size() * 2));
+		for (std::size_t i = 0; i < l.count; ++i)
+			bigger[i] = std::move(l.ring[(l.head + i) & (l.ring.size() - 1)]);
+		l.ring.swap(bigger);
+		l.head = 0;
+	}
+	l.ring[(l.head + l.count) & (l.ring.size() - 1)] = e;
+	++l.count;
+	waiting |= 1u << prio;
+}
+
+//takes oldest event of highest waiting priority, marking its priority empty if it was the last one
+event_engine::event event_engine::pop() {
+	const int prio = event_handler::highest(waiting);
+	level& l = levels[prio];
+	event e = std::move(l.ring[l.head]);
+	l.head = (l.head + 1) & (l.ring.size() - 1);
+	if (--l.count == 0)
+		waiting &= ~(1u << prio);
+	return e;
+}
+
+void event_engine::add_outcome(const outcome& o) {
+	std::visit([this](const auto& e) { add_event(e); }, o);
+}
+
+void event_engine::run_events() {
+	//execute all events
+	while (waiting != 0)
+	{
+		event e = pop();
+		++ran;
+		std::visit([this](auto& ev) { run(ev); }, e);
+	}
+}
+
+void event_engine::clear_events() {
+	for (level& l : levels)
+		l.head = l.count = 0;
+	waiting = 0;
+}
+
+//returns type of event at top of queue; returns -1 if queue is empty
+int event_engine::top_prio() const { return event_handler::highest(waiting); }
+
+void event_engine::complete(int prio, void (room_handler::* notify)()) {
+	game_io& io = *ctx.io;
+	if (prio == game_event::INPUT)
+		io.out() << std::endl;	//print newline for readability
+
+	if ((prio == game_event::COMBAT || prio == game_event::ROOM_OVER) && top_prio() != game_event::FEEDBACK)
+	{
+		if (prio == game_event::COMBAT)
+			io.out() << "Press enter to start combat." << std::endl;		//let player know that they're entering combat
+		else
+			io.out() << "Press enter to continue." << std::endl;			//prompt player to press enter
+		io.wait_enter();
+	}
+
+	//notify room_handler of event, if it has a notification function
+	if (notify != nullptr) (ctx.rh->*notify)();
+}
+
+//only enemy_defend and player_defend have partial forms
+bool event_engine::partial(outcome& o, double accuracy) {
+	if (enemy_defend* e = std::get_if<enemy_defend>(&o))
+	{
+		e->accuracy = accuracy;
+		return true;
+	}
+	if (player_defend* e = std::get_if<player_defend>(&o))
+	{
+		//the better the attempt, the less of the hit lands
+		e->dmg = static_cast<int>(e->dmg * (1.0 - accuracy) + 0.5);
+		e->grazed = true;
+		return true;
+	}
+	return false;
+}
+
+//--------------------------------------------
+//----GAMESTATE/ROOM EVENT IMPLEMENTATIONS----
+//--------------------------------------------
+
+void event_engine::run(game_intro& e) {
+	game_io& io = *ctx.io;
+	//print intro
+	io.out() << "Welcome to Goblins! Prepare to go from room to room in a dungeon." << std::endl;
+	io.out() << "In each room, goblins will line up to fight you, one at a time." << std::endl;
+	io.out() << "Attack the goblins and dodge their attacks by quickly typing in the words they throw at you!" << std::endl;
+	io.out() << "Be warned that if you either spell the word wrong or fail to type it in time," << std::endl;
+	io.out() << "you will either miss your attack or get hit by that of goblin's. It's not case-sensitive, though." << std::endl;
+	io.out() << "You'll move to the next room once there are no goblins left in line." << std::endl;
+
+	add_event(choice(player_start(), player_quit(), "Start", "Quit"));
+	complete(e);
+}
+
+void event_engine::run(turn_over& e) {
+	complete(e); //just complete the event
+}
+
+void event_engine::run(room_over& e) {
+	game_io& io = *ctx.io;
+	io.out() << "There are no more goblins in the room. You go and step into the next room." << std::endl;
+	ctx.rh->room_over();							//evaluate player performance
+	ctx.enh->set_stage(ctx.rh->get_performance());	//update stage
+	ctx.enh->set_thresholds();						//update thresholds
+	complete(e);
+}
+
+//-----------------------------------
+//----INPUT EVENT IMPLEMENTATIONS----
+//-----------------------------------
+
+void event_engine::run(combat& e) {
+	game_io& io = *ctx.io;
+	//time that event started checking for input
+	std::chrono::steady_clock::time_point start_t = io.now();
+
+	//generate a string based on the type
+	const word_handler::held_word word = ctx.wh->get_string(ctx.enh->get_type());	//keeps word valid through a reload
+	std::string_view str = word;
+
+	//prompt user for string
+	std::string& user_str = io.typing();
+	io.out() << "Type \"" << str << "\"." << std::endl;
+	unsigned int limit_t = static_cast<unsigned int>(str.size() * 250 + 1500); //250 milliseconds per letter, plus 1.5 seconds to read
+	//the enemy's clock starts once the word is shown -- its strike cuts the word short
+	const std::chrono::steady_clock::time_point strike_t = e.patience != 0 ?
+		start_t + std::chrono::milliseconds(e.patience) : std::chrono::steady_clock::time_point::max();
+	const bool cut = strike_t < start_t + std::chrono::milliseconds(limit_t);
+	if (cut)
+		limit_t = strike_t > start_t ? static_cast<unsigned int>(
+			std::chrono::duration_cast<std::chrono::milliseconds>(strike_t - start_t).count()) : 0;
+	io.read_word(user_str, str, start_t + std::chrono::milliseconds(limit_t));
+
+	//calculate time to complete
+	unsigned int wait_t = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+		io.now() - start_t).count());
+
+	//check that strings match, and that maximum time wasn't exceeded
+	bool in_time = wait_t < limit_t;
+	bool passed = in_time && ctx.wh->string_compare(str, user_str);
+	if (cut && !in_time)
+		io.out() << "The " << ctx.enh->curr_name() << " strikes before you finish!" << std::endl;
+
+	//in graded mode, a near miss in time gives partial credit to whichever outcome accepts it
+	if (!passed && in_time && ctx.wh->is_graded())
+	{
+		double acc = ctx.wh->accuracy(str, user_str);
+		if (acc >= combat_event::NEAR_MISS && !(passed = partial(e.pass, acc)))
+			partial(e.fail, acc);
+	}
+	add_outcome(passed ? e.pass : e.fail);
+
+	//wait for user to lift enter
+	io.wait_enter();
+	complete(e);
+}
+
+void event_engine::run(choice& e) {
+	game_io& io = *ctx.io;
+	std::string user_str;
+	std::size_t match;
+	do {
+		//prompt user for string until entry matches either pass string or fail string
+		io.out() << "Type \"" << e.pass_word << "\" or \"" << e.fail_word << "\"." << std::endl;
+		io.read_choice(user_str, e.pass_word, e.fail_word);
+		const std::string_view options[2] = { e.pass_word, e.fail_word };
+		match = ctx.wh->string_match(user_str, options, 2);
+
+		if (match == 2)
+		{
+			//input matches neither; prompt user to try again
+			io.out() << "Sorry, input was not recognized. Please try again." << std::endl;
+		}
+
+	} while (match == 2);
+	add_outcome(match == 0 ? e.pass : e.fail);
+
+	io.wait_enter();
+	complete(e);
+}
+
+//-----------------------------------
+//----ENEMY EVENT IMPLEMENTATIONS----
+//-----------------------------------
+
+void event_engine::run(enemy_spawn& e) {
+	game_io& io = *ctx.io;
+	ctx.enh->spawn();
+	io.out() << "A " << ctx.enh->last_name() << " just got in line!" << std::endl;
+	io.out() << "HP: " << ctx.enh->hp_back() << ", " << "ATK: " << ctx.enh->attack_back() << std::endl;
+
+	int gobs_left = ctx.enh->enemies_left();
+	if (gobs_left != 1)
+		io.out() << "There are now " << gobs_left << " goblins in line." << std::endl;
+	else
+		io.out() << "There is now " << gobs_left << " goblin in line." << std::endl; //singular
+	complete(e);
+}
+
+void event_engine::run(enemy_attack& e) {
+	game_io& io = *ctx.io;
+	//check that there are enemies
+	if (!ctx.enh->empty())
+	{
+		io.out() << "The " << ctx.enh->curr_name() << " is attacking!" << std::endl;
+		add_event(combat(player_dodge(), player_defend(ctx.enh->attack())));
+		complete(e);
+	}
+}
+
+void event_engine::run(enemy_defend& e) {
+	game_io& io = *ctx.io;
+	//a glancing blow still does at least 1 damage
+	int dmg = ctx.p->attack();
+	if (e.accuracy < 1.0)
+	{
+		dmg = std::max(1, static_cast<int>(dmg * e.accuracy + 0.5));
+		io.out() << "A glancing blow!" << std::endl;
+	}
+
+	io.out() << "The " << ctx.enh->curr_name() << " takes " << dmg << " damage!" << std::endl;
+	ctx.enh->defend(dmg);
+
+	//check if enemy is alive; kill if dead
+	if (!ctx.enh->alive())
+		add_event(enemy_die());
+	else
+		io.out() << "It still has " << ctx.enh->hp() << " hp." << std::endl;
+	complete(e);
+}
+
+void event_engine::run(enemy_die& e) {
+	game_io& io = *ctx.io;
+	io.out() << "The " << ctx.enh->curr_name() << " is dead!" << std::endl;
+	add_event(player_exp(ctx.enh->exp()));	//give player exp
+
+	//kill enemy
+	ctx.enh->die();
+
+	int gobs_left = ctx.enh->enemies_left();
+	if (gobs_left)
+	{
+		//enemy at front of new line is different; notify player
+		io.out() << "A " << ctx.enh->curr_name() << " steps up to take its place." << std::endl;
+		if (gobs_left != 1)
+			io.out() << "There are " << gobs_left << " goblins left in line." << std::endl;
+		else
+			io.out() << "There is " << gobs_left << " goblin left in line." << std::endl; //singular
+	}
+	else
+		add_event(room_over());	//create a new room
+	complete(e);
+}
+
+//------------------------------------
+//----PLAYER EVENT IMPLEMENTATIONS----
+//------------------------------------
+
+void event_engine::run(player_attack& e) {
+	game_io& io = *ctx.io;
+	io.out() << "Attack the " << ctx.enh->curr_name() << "!" << std::endl;
+	//the enemy strikes once its patience runs out, so the player's word is cut short there
+	add_event(combat(enemy_defend(), player_miss(), ctx.enh->patience()));
+	complete(e);
+}
+
+void event_engine::run(player_miss& e) {
+	game_io& io = *ctx.io;
+	io.out() << "You missed!" << std::endl;
+	complete(e);
+}
+
+void event_engine::run(player_dodge& e) {
+	game_io& io = *ctx.io;
+	io.out() << "You dodged the attack!" << std::endl;
+	complete(e);
+}
+
+void event_engine::run(player_defend& e) {
+	game_io& io = *ctx.io;
+	if (e.grazed)
+		io.out() << "You partly dodged the attack." << std::endl;
+	io.out() << "You got hit and took " << e.dmg << " damage." << std::endl;
+	ctx.p->defend(e.dmg);
+	if (!ctx.p->alive()) //kill player if hp drops below zero
+		add_event(player_die());
+	else
+		io.out() << "You still have " << ctx.p->health() << " hp." << std::endl;
+	complete(e);
+}
+
+void event_engine::run(player_exp& e) {
+	game_io& io = *ctx.io;
+	io.out() << "You gained " << e.exp << " EXP!" << std::endl;
+	ctx.p->gain_exp(e.exp);
+
+	//check that player has leveled up
+	if (ctx.p->can_level())
+		add_event(player_levelup());
+	complete(e);
+}
+
+void event_engine::run(player_levelup& e) {
+	game_io& io = *ctx.io;
+	io.out() << "You leveled up!" << std::endl;
+	ctx.p->level_up();
+	ctx.p->print_stats(io.out());
+	complete(e);
+}
+
+void event_engine::run(player_die& e) {
+	game_io& io = *ctx.io;
+	io.out() << "You died. Would you like to continue?" << std::endl;
+	add_event(choice(player_continue(), player_quit()));	//add choice to continue/quit
+	complete(e);
+}
+
+void event_engine::run(player_continue& e) {
+	game_io& io = *ctx.io;
+	//restart the room, but keep most metrics
+	io.out() << "Reseting the room." << std::endl;
+	ctx.p->fully_heal();
+	ctx.rh->reset();
+	ctx.enh->kill_all();
+	complete(e);
+}
+
+void event_engine::run(player_start& e) {
+	game_io& io = *ctx.io;
+	io.out() << "You walk into the dungeon. It smells like goblin in here!" << std::endl;
+	complete(e);
+}
+
+void event_engine::run(player_quit&) {
+	game_io& io = *ctx.io;
+	io.out() << "Thanks for playing!" << std::endl;
+	ctx.p->game_over();		//ensure hp is zero; player is dead
+	clear_events();			//clear queue
+	//do not call complete; no need to call callback or wait for user
+}
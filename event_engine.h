@@ -0,0 +1,153 @@
+/*
+* Justin W Li
+* event_engine.h
+* flat event engine class definition
+*/
+
+#ifndef EVENT_ENGINE_H
+#define EVENT_ENGINE_H
+
+#include "event_handler.h"
+
+#include <cstddef>	//std::size_t
+#include <cstdint>	//std::uint64_t
+#include <variant>	//std::variant, std::visit
+#include <vector>	//std::vector
+
+//--------------------------
+//----EVENT ENGINE CLASS----
+//--------------------------
+
+//runs the same game as event_handler, with the event set closed into one std::variant
+//events are plain values queued in place and dispatched with std::visit -- no allocation or virtual call per event,
+//and the handlers every game_event points to are held once, in the engine's context
+class event_engine {
+public:
+	//handlers events act on
+	struct context {
+		room_handler* rh;
+		word_handler* wh;
+		enemy_handler* enh;
+		player* p;
+		game_io* io;
+	};
+
+	//priority of an event type, and the room_handler function it notifies when it completes
+	template<int PRIO, void (room_handler::* NOTIFY_)() = nullptr>
+	struct kind {
+		static const int PRIORITY = PRIO;
+		static constexpr void (room_handler::* NOTIFY)() = NOTIFY_;
+	};
+
+	//events -- each holds only what it needs beyond the context; see event_handler.h for what each does
+	struct game_intro : kind<game_event::INPUT> {};
+	struct turn_over : kind<game_event::ROOM, &room_handler::turnOver> {};
+	struct room_over : kind<game_event::ROOM_OVER, &room_handler::room_over> {};
+	struct enemy_spawn : kind<game_event::SPAWN, &room_handler::enemySpawn> {};
+	struct enemy_attack : kind<game_event::COMBAT> {};
+	struct enemy_defend : kind<game_event::FEEDBACK, &room_handler::playerAttack> {
+		double accuracy = 1.0;			//fraction of player's attack that lands
+	};
+	struct enemy_die : kind<game_event::FEEDBACK, &room_handler::enemyDie> {};
+	struct player_attack : kind<game_event::COMBAT> {};
+	struct player_miss : kind<game_event::FEEDBACK> {};
+	struct player_dodge : kind<game_event::FEEDBACK, &room_handler::playerDodge> {};
+	struct player_defend : kind<game_event::FEEDBACK> {
+		int dmg;						//enemy attack value
+		bool grazed = false;			//whether player partly dodged
+		explicit player_defend(int dmg_) : dmg(dmg_) {}
+	};
+	struct player_exp : kind<game_event::FEEDBACK> {
+		int exp;						//exp to be gained
+		explicit player_exp(int exp_) : exp(exp_) {}
+	};
+	struct player_levelup : kind<game_event::FEEDBACK> {};
+	struct player_die : kind<game_event::FEEDBACK, &room_handler::playerDie> {};
+	struct player_continue : kind<game_event::FEEDBACK> {};
+	struct player_start : kind<game_event::INPUT> {};
+	struct player_quit : kind<game_event::INPUT> {};
+
+	//events typing can lead to
+	using outcome = std::variant<enemy_defend, player_miss, player_dodge, player_defend,
+		player_continue, player_start, player_quit>;
+
+	//input events -- queue pass or fail outcome, depending on what the player types
+	struct combat : kind<game_event::INPUT> {
+		outcome pass;
+		outcome fail;
+		int patience;					//milliseconds from the word being shown to the enemy's strike, cutting the word
+										//short; 0 if it does not strike
+		combat(const outcome& pass_, const outcome& fail_, int patience_ = 0) :
+			pass(pass_), fail(fail_), patience(patience_) {}
+	};
+	struct choice : kind<game_event::INPUT> {
+		outcome pass;
+		outcome fail;
+		const char* pass_word;
+		const char* fail_word;
+		choice(const outcome& pass_, const outcome& fail_, const char* pass_word_ = "Yes", const char* fail_word_ = "No") :
+			pass(pass_), fail(fail_), pass_word(pass_word_), fail_word(fail_word_) {}
+	};
+
+	using event = std::variant<game_intro, turn_over, room_over, enemy_spawn, enemy_attack, enemy_defend,
+		enemy_die, player_attack, player_miss, player_dodge, player_defend, player_exp, player_levelup,
+		player_die, player_continue, player_start, player_quit, combat, choice>;
+
+private:
+	static const int LEVELS = game_event::INPUT + 1;	//number of event priorities
+
+	//events of one priority, oldest first, in a ring that grows when full and is reused after
+	struct level {
+		std::vector<event> ring;
+		std::size_t head;
+		std::size_t count;
+	};
+
+	context ctx;
+	level levels[LEVELS];								//queue of events spawning, one fifo per priority
+	unsigned int waiting;								//bit per priority whose fifo is not empty
+	std::uint64_t ran;									//events run so far
+
+	void push(int prio, const event& e);				//adds event to back of its priority's fifo
+	event pop();										//takes oldest event of highest waiting priority
+	void add_outcome(const outcome& o);					//adds outcome as the event it holds
+	static bool partial(outcome& o, double accuracy);	//scales outcome by accuracy of a near miss; false if it has no partial form
+	void complete(int prio, void (room_handler::* notify)());	//what every event does once it has run -- see game_event::complete_event
+
+	template<class E>
+	void complete(const E&) { complete(E::PRIORITY, E::NOTIFY); }
+
+	//what each event does
+	void run(game_intro& e);
+	void run(turn_over& e);
+	void run(room_over& e);
+	void run(enemy_spawn& e);
+	void run(enemy_attack& e);
+	void run(enemy_defend& e);
+	void run(enemy_die& e);
+	void run(player_attack& e);
+	void run(player_miss& e);
+	void run(player_dodge& e);
+	void run(player_defend& e);
+	void run(player_exp& e);
+	void run(player_levelup& e);
+	void run(player_die& e);
+	void run(player_continue& e);
+	void run(player_start& e);
+	void run(player_quit& e);
+	void run(combat& e);
+	void run(choice& e);
+
+public:
+	explicit event_engine(const context& ctx_);
+
+	template<class E>
+	void add_event(const E& e) { push(E::PRIORITY, e); }	//adds event to queue
+	void run_events();									//runs events until queue is empty
+	void clear_events();								//clears event queue
+	int top_prio() const;								//returns type of event at top of queue; returns -1 if queue is empty
+	std::uint64_t events_run() const { return ran; }
+	void set_io(game_io& io_) { ctx.io = &io_; }
+};
+
+#endif
@@ -6,24 +6,54 @@
 */
 
 #include "event_handler.h"
+#include <algorithm>	//std::max, std::find
+#include <cstdio>		//std::snprintf
+#include <new>			//std::bad_alloc
+#include <ostream>		//std::ostream
 
 //-------------------------------------
 //----EVENT HANDLER IMPLEMENTATIONS----
 //-------------------------------------
 
+//highest set bit of each combination of waiting priorities; -1 if none are
+static const signed char HIGHEST[64] = {
+	-1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+	4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+	5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5
+};
+static_assert(sizeof(HIGHEST) == 1u << (game_event::INPUT + 1), "HIGHEST must cover every priority");
+
 //ctor
-event_handler::event_handler() : events(), curr_event(nullptr) {}
+event_handler::event_handler() : levels(), origin(std::chrono::steady_clock::now()), timers(), free_timers(), early_timers(), sleeping(false),
+	waiting(0), curr_event(nullptr), ran(0), io(&game_io::console()), latency(new latency_histogram[2 * game_event::TYPES]),
+	blocked(0), input_waits(0), done_t(), chained(false) {}
 
 //dtor
 event_handler::~event_handler() { clear_events(); } //delete each event in the event list
 
-//comparison function
-bool event_handler::comp::operator()(game_event* lhs, game_event* rhs) const
-{
-	return lhs->get_prio() < rhs->get_prio();
+//highest priority with its bit set in levels
+int event_handler::highest(unsigned int levels) { return HIGHEST[levels]; }
+
+//oldest event of highest waiting priority
+game_event* event_handler::top() const {
+	const int prio = HIGHEST[waiting];
+	return prio < 0 ? nullptr : levels[prio].head;
 }
 
-//adds event to queue
+//unlinks top event, marking its priority empty if it was the last one
+void event_handler::pop() {
+	const int prio = HIGHEST[waiting];
+	level& l = levels[prio];
+	l.head = l.head->next;
+	if (l.head == nullptr)
+	{
+		l.tail = nullptr;
+		waiting &= ~(1u << prio);
+	}
+}
+
+//adds event to back of its priority's fifo, so events of equal priority run in the order they were added
 void event_handler::add_event(game_event* e) {
 	if (e == nullptr) 
 	{
@@ -31,8 +61,170 @@ void event_handler::add_event(game_event* e) {
 		return;
 	}
 
-	//make pair and push
-	events.push(e);
+	level& l = levels[e->priority];
+	e->next = nullptr;
+	if (l.tail != nullptr)
+		l.tail->next = e;
+	else
+		l.head = e;
+	l.tail = e;
+	waiting |= 1u << e->priority;
+}
+
+//hands event to thread running events -- wait-free, so input, timer or network threads never block the game
+//it is queued at the top of run_events' next iteration, and runs in order with others of its priority from then on;
+//events posted by one thread keep the order they were posted in
+//event must be made with plain new, and not touched again by the thread posting it
+void event_handler::post_event(game_event* e) {
+	if (e == nullptr)
+		throw event_handler::bad_event();
+	posted.push(e);
+
+	//wait_events says it is going to sleep before it last looks at posted; this looks after posting -- so of the
+	//two, at least one sees the other
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleeping.load(std::memory_order_relaxed))
+	{
+		std::lock_guard<std::mutex> hold(sleep_lock);
+		wake.notify_one();
+	}
+}
+
+//event is due on the first tick at or after when, so unless early, it never runs before then
+//event is the handler's from then on, to run or to delete when cancelled -- made in its pool, as for add_event
+event_handler::timer_id event_handler::schedule_event(game_event* e, std::chrono::steady_clock::time_point when,
+	bool early) {
+	if (e == nullptr)
+		throw event_handler::bad_event();
+
+	std::uint32_t index;
+	if (!free_timers.empty())
+	{
+		index = free_timers.back();
+		free_timers.pop_back();
+	}
+	else
+	{
+		index = static_cast<std::uint32_t>(timers.size());
+		timers.push_back({ nullptr, 0, std::chrono::steady_clock::time_point(), false });
+	}
+	timers[index].e = e;
+	timers[index].when = when;
+	timers[index].early = early;
+	if (early)
+	{
+		//behind every early timer it outranks; ahead of those as urgent, so they run in the order they were scheduled
+		std::vector<std::uint32_t>::iterator at = early_timers.begin();
+		while (at != early_timers.end() && more_urgent(index, *at))
+			++at;
+		early_timers.insert(at, index);
+	}
+
+	std::uint64_t due = 0;
+	if (when > origin)
+	{
+		const std::chrono::nanoseconds wait = when - origin;
+		due = static_cast<std::uint64_t>((wait.count() + 999999) / 1000000);		//rounds up
+	}
+	wheel_node* n = e;
+	n->tag = index;
+	wheel.insert(n, due);
+	return { index, timers[index].gen };
+}
+
+bool event_handler::cancel_event(timer_id id) {
+	if (id.index >= timers.size() || timers[id.index].gen != id.gen || timers[id.index].e == nullptr)
+		return false;
+	game_event* e = timers[id.index].e;
+	wheel.cancel(e);
+	free_timer(id.index);
+	delete e;
+	return true;
+}
+
+void event_handler::free_timer(std::uint32_t index) {
+	if (timers[index].early)
+		early_timers.erase(std::find(early_timers.begin(), early_timers.end(), index));
+	timers[index].e = nullptr;
+	timers[index].early = false;
+	++timers[index].gen;
+	free_timers.push_back(index);
+}
+
+//moves events due by now into their priorities' fifos, in the order they came due
+void event_handler::take_due() {
+	if (wheel.empty())
+		return;
+	const std::chrono::nanoseconds since = std::chrono::steady_clock::now() - origin;
+	wheel.advance(static_cast<std::uint64_t>(since.count() / 1000000));
+	while (wheel_node* n = wheel.pop_expired())
+	{
+		free_timer(n->tag);
+		add_event(static_cast<game_event*>(n));
+	}
+}
+
+//higher priority first; of the same priority, the one due sooner
+bool event_handler::more_urgent(std::uint32_t a, std::uint32_t b) const {
+	const timer& x = timers[a];
+	const timer& y = timers[b];
+	return x.e->priority > y.e->priority || (x.e->priority == y.e->priority && x.when < y.when);
+}
+
+//queues the most urgent scheduled event that may run early, if nothing queued outranks it; run_events looks again
+//before every event, so the rest follow once it has run
+void event_handler::take_early() {
+	const std::uint32_t index = early_timers.back();
+	if (timers[index].e->priority <= HIGHEST[waiting])
+		return;
+	game_event* e = timers[index].e;
+	wheel.cancel(e);
+	free_timer(index);
+	add_event(e);
+}
+
+//sleeps until the next scheduled event is due, or another thread posts one -- never waking just to look
+//returns true as soon as any event is queued; run_events runs it
+bool event_handler::wait_events(std::chrono::steady_clock::time_point until) {
+	for (;;)
+	{
+		take_posted();
+		take_due();
+		if (!early_timers.empty())
+			take_early();
+		if (waiting != 0)
+			return true;
+
+		std::chrono::steady_clock::time_point wake_t = until;
+		const std::uint64_t next = wheel.next_wake();
+		if (next != timing_wheel::NEVER && origin + std::chrono::milliseconds(next) < wake_t)
+			wake_t = origin + std::chrono::milliseconds(next);
+		if (until != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= until)
+			return false;
+
+		std::unique_lock<std::mutex> hold(sleep_lock);
+		sleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (posted.empty())
+		{
+			if (wake_t == std::chrono::steady_clock::time_point::max())
+				wake.wait(hold);
+			else
+				wake.wait_until(hold, wake_t);
+		}
+		sleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+//moves posted events into their priorities' fifos, in the order they were posted
+void event_handler::take_posted() {
+	while (!posted.empty())
+	{
+		mpsc_node* n = posted.pop();
+		if (n == nullptr)
+			return;			//next one is halfway posted -- it will be there next time
+		add_event(static_cast<game_event*>(n));
+	}
 }
 
 //replaces current event with event at top of queue; pops queue
@@ -43,19 +235,34 @@ bool event_handler::next_event() {
 		delete curr_event;
 		curr_event = nullptr;
 	}
-	if (!events.empty())
+	if (waiting != 0)
 	{
-		curr_event = events.top();
-		events.pop();
+		curr_event = top();
+		pop();
+		++ran;
+		blocked = std::chrono::steady_clock::duration(0);
+		input_waits = 0;
 		return true;
 	}
 	else return false;
 }
 
 void event_handler::run_events() {
-	//execute all events
-	while (!events.empty())
-		events.top()->start_event();
+	//execute all events, taking in any posted or come due since the last one ran
+	chained = false;
+	for (;;)
+	{
+		take_posted();
+		take_due();
+		if (!early_timers.empty())
+			take_early();
+		if (waiting == 0)
+		{
+			chained = false;
+			return;
+		}
+		top()->start_event();
+	}
 }
 
 void event_handler::clear_events() {
@@ -66,19 +273,80 @@ void event_handler::clear_events() {
 		curr_event = nullptr;
 	}
 
-	//delete every event in queue
-	while (!events.empty())
+	//delete every event in queue, posted and scheduled ones included
+	take_posted();
+	for (std::uint32_t i = 0; i < timers.size(); ++i)
 	{
-		game_event* e = events.top();
-		events.pop();
+		if (timers[i].e != nullptr)
+			cancel_event({ i, timers[i].gen });
+	}
+	while (waiting != 0)
+	{
+		game_event* e = top();
+		pop();
 		delete e;
 	}
 }
 
 //returns type of event at top of queue; returns -1 if queue is empty
-int event_handler::top_prio() const {
-	if (events.empty()) return -1;
-	else return events.top()->get_prio();
+int event_handler::top_prio() const { return HIGHEST[waiting]; }
+
+//an event run_events goes straight on to is dispatched as the one before it finishes -- taking in posted and due
+//events between them counts towards its time, as the work of dispatching it
+std::chrono::steady_clock::time_point event_handler::dispatch_time() const {
+	return chained ? done_t : std::chrono::steady_clock::now();
+}
+
+//waiting on the player is only recorded for events that did, so types that never wait have nothing to show for it
+void event_handler::record_latency(int type, std::chrono::steady_clock::time_point start_t) {
+	done_t = std::chrono::steady_clock::now();
+	chained = true;
+	if (type < 0 || type >= game_event::TYPES)
+		type = game_event::OTHER_TYPE;
+	latency[type].record(static_cast<std::uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(done_t - start_t).count()));
+	if (input_waits != 0)
+		latency[game_event::TYPES + type].record(static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(blocked).count()));
+}
+
+const latency_histogram& event_handler::run_latency(int type) const {
+	if (type < 0 || type >= game_event::TYPES)
+		throw "run_latency(): invalid event type!\n";
+	return latency[type];
+}
+
+const latency_histogram& event_handler::input_latency(int type) const {
+	if (type < 0 || type >= game_event::TYPES)
+		throw "input_latency(): invalid event type!\n";
+	return latency[game_event::TYPES + type];
+}
+
+//one row of print_latency, in milliseconds -- formatted apart from out, so its flags are left as they were
+static void print_row(std::ostream& out, const char* name, const latency_histogram& h) {
+	char row[128];
+	std::snprintf(row, sizeof(row), "%-18s %8llu %9.3f %9.3f %9.3f %9.3f", name,
+		static_cast<unsigned long long>(h.count()), h.percentile(50) / 1e6, h.percentile(90) / 1e6,
+		h.percentile(99) / 1e6, h.max() / 1e6);
+	out << row << std::endl;
+}
+
+void event_handler::print_latency(std::ostream& out) const {
+	const char* header = "event                  runs       p50       p90       p99       max";
+	out << "Time from dispatch to completion, in ms:" << std::endl << header << std::endl;
+	for (int type = 0; type < game_event::TYPES; ++type)
+		if (latency[type].count() != 0)
+			print_row(out, game_event::type_name(type), latency[type]);
+
+	out << "Time spent waiting on the player, in ms:" << std::endl << header << std::endl;
+	for (int type = 0; type < game_event::TYPES; ++type)
+		if (latency[game_event::TYPES + type].count() != 0)
+			print_row(out, game_event::type_name(type), latency[game_event::TYPES + type]);
+}
+
+void event_handler::reset_latency() {
+	for (int i = 0; i < 2 * game_event::TYPES; ++i)
+		latency[i].reset();
 }
 
 //----------------------------------
@@ -88,27 +356,54 @@ int event_handler::top_prio() const {
 //event function implementations
 game_event::game_event(event_handler* evh_, room_handler* rh_, int prio, 
 	void (room_handler::* pNotify_)()) :
-	evh(evh_), rh(rh_), priority(prio), pNotify(pNotify_) {
+	evh(evh_), rh(rh_), priority(prio), pNotify(pNotify_), next(nullptr) {
 	if (evh_ == nullptr) throw EVENT_EXCEPTION("Invalid event handler pointer!\n");
 	if (rh_ == nullptr) throw EVENT_EXCEPTION("Invalid room handler pointer!\n");
+	if (prio < ROOM_OVER || prio > INPUT) throw EVENT_EXCEPTION("Invalid event priority!\n");
+}
+
+void* game_event::operator new(std::size_t size, event_handler* evh_) {
+	//with no handler there is no pool to allocate from -- fail as any allocation does, which is what every
+	//new (evh) is wrapped to catch
+	if (evh_ == nullptr) throw std::bad_alloc();
+	return evh_->get_pool().allocate(size);
 }
 
+void* game_event::operator new(std::size_t size) { return event_pool::allocate_heap(size); }
+
+void game_event::operator delete(void* ptr, event_handler*) { event_pool::release(ptr); }
+void game_event::operator delete(void* ptr) { event_pool::release(ptr); }
+
 void game_event::start_event() { 
 	//delete current event if necessary, then place event at top of queue into current_event
-	if(evh->next_event()) run_event();
+	if(evh->next_event())
+	{
+		//player_quit deletes itself along with the queue -- nothing of the event is touched once it has run
+		event_handler* const handler = evh;
+		const int type = get_type();
+		const std::chrono::steady_clock::time_point start_t = handler->dispatch_time();
+		{
+			GOBLINS_TRACE_EVENT(get_name(), "event", get_name(), priority);
+			run_event();
+		}
+		handler->record_latency(type, start_t);
+	}
 }
 
 void game_event::complete_event() { 
+	game_io& io = evh->get_io();
 	if (priority == INPUT)
-		std::cout << std::endl;	//print newline for readability
+		io.out() << std::endl;	//print newline for readability
 
 	if((priority == COMBAT || priority == ROOM_OVER) && evh->top_prio() != FEEDBACK)
 	{
 		if(priority == COMBAT)
-			std::cout << "Press enter to start combat." << std::endl;		//let player know that they're entering combat
+			io.out() << "Press enter to start combat." << std::endl;		//let player know that they're entering combat
 		else
-			std::cout << "Press enter to continue." << std::endl;			//prompt player to press enter
-		while (std::cin.get() != '\n');
+			io.out() << "Press enter to continue." << std::endl;			//prompt player to press enter
+		GOBLINS_TRACE_EVENT("wait_enter", "input", get_name(), priority);
+		event_handler::input_wait timer(evh);
+		io.wait_enter();
 	}
 
 	//notify room_handler of event, if notification function was inputted
@@ -116,6 +411,19 @@ void game_event::complete_event() {
 }
 int game_event::get_prio() const { return priority; }
 
+//names of event classes, by TYPE
+static const char* const TYPE_NAMES[] = {
+	"game_intro", "turn_over", "room_over", "combat_event", "non_combat_event",
+	"enemy_spawn", "enemy_attack", "enemy_defend", "enemy_die", "player_attack", "player_miss",
+	"player_dodge", "player_defend", "player_exp", "player_levelup", "player_die",
+	"player_continue", "player_start", "player_quit", "other"
+};
+static_assert(sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]) == game_event::TYPES, "TYPE_NAMES must name every type");
+
+const char* game_event::type_name(int type) {
+	return type >= 0 && type < TYPES ? TYPE_NAMES[type] : TYPE_NAMES[OTHER_TYPE];
+}
+
 enemy_event::enemy_event(event_handler* evh_, room_handler* rh_, 
 	enemy_handler* enh_, int prio,
 	void (room_handler::* pNotify_)(), std::string(enemy_handler::* pName_)() const) try :
@@ -138,8 +446,8 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 
 //input reception event
 input_event::input_event(event_handler* evh_, room_handler* rh_, word_handler* wh_,
-	game_event* pPassEvent_, game_event* pFailEvent_, int prio) try :
-	game_event(evh_, rh_, prio), wh(wh_), pPassEvent(pPassEvent_), pFailEvent(pFailEvent_) { 
+	const outcome& pass_outcome_, const outcome& fail_outcome_, int prio) try :
+	game_event(evh_, rh_, prio), wh(wh_), pass_outcome(pass_outcome_), fail_outcome(fail_outcome_) { 
 	if (wh_ == nullptr) throw EVENT_EXCEPTION("Invalid word handler pointer!\n");
 }
 catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializer list
@@ -150,21 +458,6 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 //----GAMESTATE/ROOM EVENT CLASSES----
 //------------------------------------
 
-//load event
-game_load::game_load(event_handler* evh_, room_handler* rh_, word_handler* wh_,	int prio) try :
-	game_event(evh_, rh_, prio), wh(wh_) {
-	if (wh_ == nullptr) throw EVENT_EXCEPTION("Invalid word handler pointer!\n");
-}
-catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializer list
-	throw e.what();
-}
-
-void game_load::run_event() {
-	std::cout << "Loading word bank..." << std::endl;
-	wh->load_bank();
-	complete_event();
-}
-
 //intro event
 game_intro::game_intro(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
 	player* p_, int prio) try :
@@ -177,19 +470,20 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 
 
 void game_intro::run_event() {
+	game_io& io = evh->get_io();
 	//print intro
-	std::cout << "Welcome to Goblins! Prepare to go from room to room in a dungeon." << std::endl;
-	std::cout << "In each room, goblins will line up to fight you, one at a time." << std::endl;
-	std::cout << "Attack the goblins and dodge their attacks by quickly typing in the words they throw at you!" << std::endl;
-	std::cout << "Be warned that if you either spell the word wrong or fail to type it in time," << std::endl;
-	std::cout << "you will either miss your attack or get hit by that of goblin's. It's not case-sensitive, though." << std::endl;
-	std::cout << "You'll move to the next room once there are no goblins left in line." << std::endl;
+	io.out() << "Welcome to Goblins! Prepare to go from room to room in a dungeon." << std::endl;
+	io.out() << "In each room, goblins will line up to fight you, one at a time." << std::endl;
+	io.out() << "Attack the goblins and dodge their attacks by quickly typing in the words they throw at you!" << std::endl;
+	io.out() << "Be warned that if you either spell the word wrong or fail to type it in time," << std::endl;
+	io.out() << "you will either miss your attack or get hit by that of goblin's. It's not case-sensitive, though." << std::endl;
+	io.out() << "You'll move to the next room once there are no goblins left in line." << std::endl;
 
 	try {
 		//add start/exit event
-		evh->add_event(new non_combat_event(evh, rh, wh,
-			new player_start(evh, rh, p),
-			new player_quit(evh, rh, p),
+		evh->add_event(new (evh) non_combat_event(evh, rh, wh,
+			outcome::of<player_start>(evh, rh, p),
+			outcome::of<player_quit>(evh, rh, p),
 			"Start", "Quit"));
 	}
 	catch (std::bad_alloc& e) { //check for alloc failure
@@ -222,7 +516,8 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void room_over::run_event() {
-	std::cout << "There are no more goblins in the room. You go and step into the next room." << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "There are no more goblins in the room. You go and step into the next room." << std::endl;
 	rh->room_over();						//evaluate player performance
 	enh->set_stage(rh->get_performance());	//update stage
 	enh->set_thresholds();					//update thresholds
@@ -233,10 +528,17 @@ void room_over::run_event() {
 //----INPUT EVENT CLASS IMPLEMENTATIONS----
 //-----------------------------------------
 
+//no strike -- its outcome is never made
 combat_event::combat_event(event_handler* evh_, room_handler* rh_,
-	word_handler* wh_, enemy_handler* enh_, game_event* pPassEvent_,
-	game_event* pFailEvent_, int prio) try :
-	input_event(evh_, rh_, wh_, pPassEvent_, pFailEvent_, prio),enh(enh_) { 
+	word_handler* wh_, enemy_handler* enh_, const outcome& pass_outcome_,
+	const outcome& fail_outcome_, int prio) :
+	combat_event(evh_, rh_, wh_, enh_, pass_outcome_, fail_outcome_, fail_outcome_, 0, prio) {}
+
+combat_event::combat_event(event_handler* evh_, room_handler* rh_,
+	word_handler* wh_, enemy_handler* enh_, const outcome& pass_outcome_,
+	const outcome& fail_outcome_, const outcome& strike_outcome_, int patience_, int prio) try :
+	input_event(evh_, rh_, wh_, pass_outcome_, fail_outcome_, prio),enh(enh_), strike_outcome(strike_outcome_),
+	patience(patience_) { 
 	if (enh_ == nullptr) throw EVENT_EXCEPTION("Invalid enemy handler pointer!\n");
 }
 catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializer list
@@ -244,109 +546,135 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void combat_event::run_event() {
+	game_io& io = evh->get_io();
 	//time that event started checking for input
-	std::chrono::steady_clock::time_point start_t = std::chrono::steady_clock::now();	
+	std::chrono::steady_clock::time_point start_t = io.now();	
 
 	//generate a string based on the type
-	std::string str = wh->get_string(enh->get_type());
+	const word_handler::held_word word = wh->get_string(enh->get_type());	//keeps word valid through a reload
+	std::string_view str = word;
 
 	//prompt user for string
-	std::string user_str;
-	std::cout << "Type \"" << str << "\"." << std::endl;
-	std::cin >> user_str;
-
-	//calculate time to complete
-	unsigned int wait_t = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(
-		std::chrono::steady_clock::now() - start_t).count());
-
-	//check that strings match, and that maximum time wasn't exceeded
-	if (wh->string_compare(str, user_str) && wait_t < (str.size() * 250 + 1500)) //250 milliseconds per letter, plus 1.5 seconds to read 
+	std::string& user_str = io.typing();
+	io.out() << "Type \"" << str << "\"." << std::endl;
+	unsigned int limit_t = static_cast<unsigned int>(str.size() * 250 + 1500); //250 milliseconds per letter, plus 1.5 seconds to read
+	//the enemy's clock starts once the word is shown -- it strikes when its patience runs out, cutting the word short,
+	//or as soon as the player's attack is over, if that is sooner
+	std::chrono::steady_clock::time_point strike_t = std::chrono::steady_clock::time_point::max();
+	if (patience != 0)
 	{
+		strike_t = start_t + std::chrono::milliseconds(patience);
 		try {
-			evh->add_event(pPassEvent);		//event failed, add fail event 
+			evh->schedule_event(strike_outcome.make(), strike_t, true);
 		}
 		catch (std::bad_alloc& e) { //check for alloc failure
 			throw e.what();
 		}
-		delete pFailEvent;					//fail event not needed; delete
 	}
-	else 
+	const bool cut = strike_t < start_t + std::chrono::milliseconds(limit_t);
+	if (cut)
+		limit_t = strike_t > start_t ? static_cast<unsigned int>(
+			std::chrono::duration_cast<std::chrono::milliseconds>(strike_t - start_t).count()) : 0;
 	{
-		try {
-			evh->add_event(pFailEvent);		//event failed, add fail event 
-		}
-		catch (std::bad_alloc& e) { //check for alloc failure
-			throw e.what();
-		}
-		delete pPassEvent;					//pass event not needed; delete
+		GOBLINS_TRACE_EVENT("read_word", "input", get_name(), priority);
+		event_handler::input_wait timer(evh);
+		io.read_word(user_str, str, start_t + std::chrono::milliseconds(limit_t));
+	}
+
+	//calculate time to complete
+	unsigned int wait_t = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+		io.now() - start_t).count());
+
+	//check that strings match, and that maximum time wasn't exceeded
+	bool in_time = wait_t < limit_t;
+	bool passed = in_time && wh->string_compare(str, user_str);
+	if (cut && !in_time)
+		io.out() << "The " << enh->curr_name() << " strikes before you finish!" << std::endl;
+
+	//in graded mode, a near miss in time gives partial credit to whichever outcome accepts it
+	bool near_miss = false;
+	double acc = 0.0;
+	if (!passed && in_time && wh->is_graded())
+	{
+		acc = wh->accuracy(str, user_str);
+		near_miss = acc >= NEAR_MISS;
+		passed = near_miss && pass_outcome.has_partial();
+	}
+
+	try {
+		//build only the outcome that was earned
+		game_event* result = passed ? pass_outcome.make() : fail_outcome.make();
+		if (near_miss)
+			result->partial(acc);
+		evh->add_event(result);
+	}
+	catch (std::bad_alloc& e) { //check for alloc failure
+		throw e.what();
 	}
 
 	//wait for user to lift enter
-	while (std::cin.get() != '\n');
+	{
+		GOBLINS_TRACE_EVENT("wait_enter", "input", get_name(), priority);
+		event_handler::input_wait timer(evh);
+		io.wait_enter();
+	}
 	complete_event();
 }
 
 non_combat_event::non_combat_event(event_handler* evh_, room_handler* rh_, 
-	word_handler* wh_, game_event* pPassEvent_, game_event* pFailEvent_, 
+	word_handler* wh_, const outcome& pass_outcome_, const outcome& fail_outcome_, 
 	std::string pass_, std::string fail_, int prio) try :
-	input_event(evh_, rh_, wh_, pPassEvent_, pFailEvent_, prio),
+	input_event(evh_, rh_, wh_, pass_outcome_, fail_outcome_, prio),
 	pass(pass_), fail(fail_) 
 {
 	//check that pass, fail don't match
 	if (wh->string_compare(pass, fail))
-	{
-		//destroy pass/fail events, throw exception
-		delete pPassEvent;
-		delete pFailEvent;
 		throw game_event::EVENT_EXCEPTION("Pass, fail strings cannot match!\n");
-	}
 }
 catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializer list
 	throw e.what();
 }
 
 void non_combat_event::run_event() {
+	game_io& io = evh->get_io();
 
 	std::string user_str;
 	bool pass_event = false;
 	bool fail_event = false;
 	do {
 		//prompt user for string until entry matches either pass string or fail string
-		std::cout << "Type \"" << pass << "\" or \"" << fail << "\"." << std::endl;
-		std::cin >> user_str;
-		pass_event = wh->string_compare(user_str, pass); 
-		fail_event = wh->string_compare(user_str, fail);
+		io.out() << "Type \"" << pass << "\" or \"" << fail << "\"." << std::endl;
+		{
+			GOBLINS_TRACE_EVENT("read_choice", "input", get_name(), priority);
+			event_handler::input_wait timer(evh);
+			io.read_choice(user_str, pass, fail);
+		}
+		const std::string_view options[2] = { pass, fail };
+		const std::size_t match = wh->string_match(user_str, options, 2);
+		pass_event = (match == 0);
+		fail_event = (match == 1);
 
 		if (!(pass_event || fail_event))
 		{
 			//input matches neither; prompt user to try again
-			std::cout << "Sorry, input was not recognized. Please try again." << std::endl;
+			io.out() << "Sorry, input was not recognized. Please try again." << std::endl;
 		}
 
 	} while (!pass_event && !fail_event);
 
-	if (pass_event)
-	{
-		try {
-			evh->add_event(pPassEvent);	//event failed, add fail event 
-		}
-		catch (std::bad_alloc& e) { //check for alloc failure
-			throw e.what();
-		}
-		delete pFailEvent;			//pass event not needed; delete
+	try {
+		//build only the outcome that was picked
+		evh->add_event(pass_event ? pass_outcome.make() : fail_outcome.make());
 	}
-	else
-	{
-		try {
-			evh->add_event(pFailEvent);		//event failed, add fail event 
-		}
-		catch (std::bad_alloc& e) { //check for alloc failure
-			throw e.what();
-		}
-		delete pPassEvent;				//pass event not needed; delete
+	catch (std::bad_alloc& e) { //check for alloc failure
+		throw e.what();
 	}
 
-	while (std::cin.get() != '\n');
+	{
+		GOBLINS_TRACE_EVENT("wait_enter", "input", get_name(), priority);
+		event_handler::input_wait timer(evh);
+		io.wait_enter();
+	}
 	complete_event();
 }
 
@@ -363,15 +691,16 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void enemy_spawn::run_event() {
+	game_io& io = evh->get_io();
 	enh->spawn();
-	std::cout << "A " << (enh->*pName)() << " just got in line!" << std::endl;
-	std::cout << "HP: " << enh->hp_back() << ", " << "ATK: " << enh->attack_back() << std::endl;
+	io.out() << "A " << (enh->*pName)() << " just got in line!" << std::endl;
+	io.out() << "HP: " << enh->hp_back() << ", " << "ATK: " << enh->attack_back() << std::endl;
 
 	int gobs_left = enh->enemies_left();
 	if (gobs_left != 1)
-		std::cout << "There are now " << gobs_left << " goblins in line." << std::endl;
+		io.out() << "There are now " << gobs_left << " goblins in line." << std::endl;
 	else
-		std::cout << "There is now " << gobs_left << " goblin in line." << std::endl; //singular
+		io.out() << "There is now " << gobs_left << " goblin in line." << std::endl; //singular
 	complete_event();
 }
 
@@ -387,16 +716,17 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void enemy_attack::run_event() {
+	game_io& io = evh->get_io();
 	//check that there are enemies
 	if (!enh->empty())
 	{
-		std::cout << "The " << (enh->*pName)() << " is attacking!" << std::endl;
+		io.out() << "The " << (enh->*pName)() << " is attacking!" << std::endl;
 
 		try {
 			//create input event
-			evh->add_event(static_cast<game_event*>(new combat_event(evh, rh, wh, enh,
-				static_cast<game_event*>(new player_dodge(evh, rh, p)),					 //event success
-				static_cast<game_event*>(new player_defend(evh, rh, wh, enh, p, enh->attack())) //event fail
+			evh->add_event(static_cast<game_event*>(new (evh) combat_event(evh, rh, wh, enh,
+				outcome::of<player_dodge>(evh, rh, p),									//event success
+				outcome::of<player_defend>(evh, rh, wh, enh, p, enh->attack())		//event fail
 			)));
 		}
 		catch (std::bad_alloc& e) { //check for alloc failure
@@ -408,30 +738,44 @@ void enemy_attack::run_event() {
 //enemy defense event function implementations
 enemy_defend::enemy_defend(event_handler* evh_, room_handler* rh_, enemy_handler* enh_, 
 	player* p_, int prio, void (room_handler::* pNotify_)()) try :
-	enemy_event(evh_, rh_, enh_, prio, pNotify_), p(p_) {
+	enemy_event(evh_, rh_, enh_, prio, pNotify_), p(p_), accuracy(1.0) {
 	if (p_ == nullptr) throw EVENT_EXCEPTION("Invalid player pointer!\n");
 }
 catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializer list
 	throw e.what();
 }
 
+bool enemy_defend::partial(double accuracy_) {
+	accuracy = accuracy_;
+	return true;
+}
+
 void enemy_defend::run_event() {
-	std::cout << "The " << (enh->*pName)() << " takes " << p->attack() << " damage!" << std::endl;
-	enh->defend(p->attack());
+	game_io& io = evh->get_io();
+	//a glancing blow still does at least 1 damage
+	int dmg = p->attack();
+	if (accuracy < 1.0)
+	{
+		dmg = std::max(1, static_cast<int>(dmg * accuracy + 0.5));
+		io.out() << "A glancing blow!" << std::endl;
+	}
+
+	io.out() << "The " << (enh->*pName)() << " takes " << dmg << " damage!" << std::endl;
+	enh->defend(dmg);
 
 	//check if enemy is alive; kill if dead
 	if (!enh->alive())
 	{
 		try {
 			//add enemy death event
-			evh->add_event(static_cast<game_event*>(new enemy_die(evh, rh, enh, p)));
+			evh->add_event(static_cast<game_event*>(new (evh) enemy_die(evh, rh, enh, p)));
 		}
 		catch (std::bad_alloc& e) { //check for alloc failure
 			throw e.what();
 		}
 	}
 	else
-		std::cout << "It still has " << enh->hp() << " hp." << std::endl;
+		io.out() << "It still has " << enh->hp() << " hp." << std::endl;
 	complete_event();
 }
 
@@ -446,11 +790,12 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void enemy_die::run_event() {
-	std::cout << "The " << (enh->*pName)() << " is dead!" << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "The " << (enh->*pName)() << " is dead!" << std::endl;
 	//give player exp
 	try {
 		//add player exp event
-		evh->add_event(static_cast<game_event*>(new player_exp(evh, rh, p, enh->exp())));
+		evh->add_event(static_cast<game_event*>(new (evh) player_exp(evh, rh, p, enh->exp())));
 	}
 	catch (std::bad_alloc& e) { //check for alloc failure
 		throw e.what();
@@ -463,17 +808,17 @@ void enemy_die::run_event() {
 	if (gobs_left)
 	{
 		//enemy at front of new line is different; notify player
-		std::cout << "A " << (enh->*pName)() << " steps up to take its place." << std::endl;
+		io.out() << "A " << (enh->*pName)() << " steps up to take its place." << std::endl;
 		if (gobs_left != 1)
-			std::cout << "There are " << gobs_left << " goblins left in line." << std::endl;
+			io.out() << "There are " << gobs_left << " goblins left in line." << std::endl;
 		else
-			std::cout << "There is " << gobs_left << " goblin left in line." << std::endl; //singular
+			io.out() << "There is " << gobs_left << " goblin left in line." << std::endl; //singular
 	}
 	else
 	{
 		//create a new room
 		try {
-			evh->add_event(static_cast<game_event*>(new room_over(evh, rh, enh)));
+			evh->add_event(static_cast<game_event*>(new (evh) room_over(evh, rh, enh)));
 		}
 		catch (std::bad_alloc& e) { //check for alloc failure
 			throw e.what();
@@ -498,13 +843,15 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 
 
 void player_attack::run_event(){
-	std::cout << "Attack the " << (enh->*pName)() << "!" << std::endl;
-	//create input event
+	game_io& io = evh->get_io();
+	io.out() << "Attack the " << (enh->*pName)() << "!" << std::endl;
+	//create input event -- the enemy's attack is scheduled by it, once the player sees their word
 	try {
 		//add player exp event
-		evh->add_event(static_cast<game_event*>(new combat_event(evh, rh, wh, enh,
-			new enemy_defend(evh, rh, enh, p),
-			new player_miss(evh, rh, p))));
+		evh->add_event(static_cast<game_event*>(new (evh) combat_event(evh, rh, wh, enh,
+			outcome::of<enemy_defend>(evh, rh, enh, p),
+			outcome::of<player_miss>(evh, rh, p),
+			outcome::of<enemy_attack>(evh, rh, wh, enh, p), enh->patience())));
 	}
 	catch (std::bad_alloc& e) { //check for alloc failure
 		throw e.what();
@@ -519,7 +866,8 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 	throw e.what();
 }
 void player_miss::run_event() {
-	std::cout << "You missed!" << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "You missed!" << std::endl;
 	complete_event();
 }
 
@@ -531,14 +879,15 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 	throw e.what();
 }
 void player_dodge::run_event() {
-	std::cout << "You dodged the attack!" << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "You dodged the attack!" << std::endl;
 	complete_event();
 }
 
 //player defense function implementations
 player_defend::player_defend(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
 	enemy_handler* enh_, player* p_,	int dmg_, int prio) try :
-	player_event(evh_, rh_, p_, prio), wh(wh_), enh(enh_), dmg(dmg_) {
+	player_event(evh_, rh_, p_, prio), wh(wh_), enh(enh_), dmg(dmg_), grazed(false) {
 	if (enh_ == nullptr) throw EVENT_EXCEPTION("Invalid enemy handler pointer!\n");
 	if (wh_ == nullptr) throw EVENT_EXCEPTION("Invalid word handler pointer!\n");
 }
@@ -546,21 +895,31 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 	throw e.what();
 }
 
+bool player_defend::partial(double accuracy) {
+	//the better the attempt, the less of the hit lands
+	dmg = static_cast<int>(dmg * (1.0 - accuracy) + 0.5);
+	grazed = true;
+	return true;
+}
+
 void player_defend::run_event() {
-	std::cout << "You got hit and took " << dmg << " damage." << std::endl;
+	game_io& io = evh->get_io();
+	if (grazed)
+		io.out() << "You partly dodged the attack." << std::endl;
+	io.out() << "You got hit and took " << dmg << " damage." << std::endl;
 	p->defend(dmg);
 	if (!p->alive()) //kill player if hp drops below zero
 	{
 		try {
 			//add player exp event
-			evh->add_event(static_cast<game_event*>(new player_die(evh, rh, wh, enh, p)));
+			evh->add_event(static_cast<game_event*>(new (evh) player_die(evh, rh, wh, enh, p)));
 		}
 		catch (std::bad_alloc& e) { //check for alloc failure
 			throw e.what();
 		}
 	}
 	else
-		std::cout << "You still have " << p->health() << " hp." << std::endl;
+		io.out() << "You still have " << p->health() << " hp." << std::endl;
 	complete_event();
 }
 
@@ -573,7 +932,8 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void player_exp::run_event() {
-	std::cout << "You gained " << exp << " EXP!" << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "You gained " << exp << " EXP!" << std::endl;
 	p->gain_exp(exp);
 
 	//check that player has leveled up
@@ -581,7 +941,7 @@ void player_exp::run_event() {
 	{
 		try {
 			//add player exp event
-			evh->add_event(static_cast<game_event*>(new player_levelup(evh, rh, p)));
+			evh->add_event(static_cast<game_event*>(new (evh) player_levelup(evh, rh, p)));
 		}
 		catch (std::bad_alloc& e) { //check for alloc failure
 			throw e.what();
@@ -599,9 +959,10 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void player_levelup::run_event() {
-	std::cout << "You leveled up!" << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "You leveled up!" << std::endl;
 	p->level_up();
-	p->print_stats();
+	p->print_stats(io.out());
 	complete_event();
 }
 
@@ -617,12 +978,13 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void player_die::run_event() {
-	std::cout << "You died. Would you like to continue?" << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "You died. Would you like to continue?" << std::endl;
 	try {
 		//add choice to continue/quit
-		evh->add_event(new non_combat_event(evh, rh, wh,
-			new player_continue(evh, rh, enh, p),
-			new player_quit(evh, rh, p)));
+		evh->add_event(new (evh) non_combat_event(evh, rh, wh,
+			outcome::of<player_continue>(evh, rh, enh, p),
+			outcome::of<player_quit>(evh, rh, p)));
 	}
 	catch (std::bad_alloc& e) { //check for alloc failure
 		throw e.what();
@@ -640,8 +1002,9 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void player_continue::run_event() {
+	game_io& io = evh->get_io();
 	//restart the room, but keep most metrics
-	std::cout << "Reseting the room." << std::endl;
+	io.out() << "Reseting the room." << std::endl;
 	p->fully_heal();
 	rh->reset();
 	enh->kill_all();
@@ -655,14 +1018,16 @@ catch (const game_event::EVENT_EXCEPTION& e) { //catch exceptions from initializ
 }
 
 void player_start::run_event() {
-	std::cout << "You walk into the dungeon. It smells like goblin in here!" << std::endl;
+	game_io& io = evh->get_io();
+	io.out() << "You walk into the dungeon. It smells like goblin in here!" << std::endl;
 	complete_event();
 }
 
 player_quit::player_quit(event_handler* evh_, room_handler* rh_, player* p_, int prio) :
 	player_event(evh_, rh_, p_, prio) {}
 void player_quit::run_event() {
-	std::cout << "Thanks for playing!" << std::endl; //todo -- score/leaderboard stuff here
+	game_io& io = evh->get_io();
+	io.out() << "Thanks for playing!" << std::endl; //todo -- score/leaderboard stuff here
 	p->game_over();			//ensure hp is zero; player is dead
 	evh->clear_events();	//clear queue
 	//do not call complete_event; no need to call callback or wait for user
@@ -12,10 +12,22 @@
 #include "room_handler.h"
 #include "word_handler.h"
 #include "player.h"
+#include "event_pool.h"
+#include "game_io.h"
+#include "mpsc_queue.h"
+#include "timing_wheel.h"
+#include "trace.h"
+#include "latency_histogram.h"
 
 #include <string>	//std::string
+#include <atomic>	//std::atomic
 #include <chrono>   //std::chrono::steady_clock, std::chrono::duration
-#include <queue>	//std::priority_queue
+#include <condition_variable>	//std::condition_variable
+#include <cstdint>	//std::uint32_t, std::uint64_t
+#include <iosfwd>	//std::ostream
+#include <memory>	//std::unique_ptr
+#include <mutex>	//std::mutex
+#include <type_traits>	//std::is_same, std::is_trivially_copyable
 #include <utility>	//std::pair, std::make_pair
 #include <vector>	//std::vector
 
@@ -28,15 +40,53 @@ class game_event;
 
 class event_handler
 {
-	//comparison class for priority queue
-	class comp {
-	public:
-		bool operator()(game_event* lhs, game_event* rhs) const;
+	static const int LEVELS = 6;						//number of event priorities
+
+	//events of one priority, oldest first, linked through the events themselves
+	struct level {
+		game_event* head;
+		game_event* tail;
+	};
+
+	//event waiting in wheel, and which use of its slot in timers it is
+	struct timer {
+		game_event* e;									//nullptr while slot is free
+		std::uint32_t gen;
+		std::chrono::steady_clock::time_point when;		//time event is due, exactly -- the wheel only keeps its tick
+		bool early;										//whether event may run before when -- see schedule_event
 	};
 
-	std::priority_queue<game_event*, 
-		std::vector<game_event*>, comp> events;			//queue of events spawning
+	event_pool pool;									//memory for events -- declared first, so it outlives them
+	level levels[LEVELS];								//queue of events spawning, one fifo per priority
+	mpsc_queue posted;									//events other threads have posted, not queued yet
+	timing_wheel wheel;									//events scheduled for a time, not queued yet
+	std::chrono::steady_clock::time_point origin;		//time of wheel's tick 0 -- a tick is a millisecond
+	std::vector<timer> timers;							//scheduled events, by slot -- see timer_id
+	std::vector<std::uint32_t> free_timers;				//slots in timers not in use
+	std::vector<std::uint32_t> early_timers;			//slots of scheduled events that may run early, most urgent last
+	std::mutex sleep_lock;								//held by wait_events while it sleeps, so post_event can wake it
+	std::condition_variable wake;
+	std::atomic<bool> sleeping;							//whether wait_events may be asleep
+	unsigned int waiting;								//bit per priority whose fifo is not empty
 	game_event* curr_event;								//current event to be executed
+	std::uint64_t ran;									//events run so far
+	game_io* io;										//where events print to and read from
+	std::unique_ptr<latency_histogram[]> latency;		//per event type, time from dispatch to completion; then time
+														//spent waiting on the player, for types that did
+	std::chrono::steady_clock::duration blocked;		//time running event has spent waiting on the player
+	unsigned int input_waits;							//waits on the player running event has made
+	std::chrono::steady_clock::time_point done_t;		//when last event finished running
+	bool chained;										//whether run_events went straight from it to the running event,
+														//so it was dispatched at done_t -- saves reading the clock
+
+	game_event* top() const;							//oldest event of highest waiting priority; nullptr if queue is empty
+	void pop();											//unlinks top event
+	void take_posted();									//queues every event posted so far
+	void take_due();									//queues every scheduled event that has come due
+	void take_early();									//queues a scheduled event that may run early, once nothing
+														//queued outranks it
+	void free_timer(std::uint32_t index);				//marks slot in timers free, so its timer_id no longer matches
+	bool more_urgent(std::uint32_t a, std::uint32_t b) const;	//whether timer a is to run early before timer b
 
 public:
 
@@ -45,13 +95,54 @@ public:
 		const char* what() const noexcept { return "Invalid event pointer!\n"; }
 	};
 
+	//names a scheduled event, to cancel it by -- safe to use after the event has run, when it simply matches nothing
+	struct timer_id {
+		std::uint32_t index;							//slot in timers
+		std::uint32_t gen;								//use of slot
+	};
+
 	event_handler();
 	~event_handler();
 	void add_event(game_event* e);						//adds event to queue
+	void post_event(game_event* e);						//adds event to queue from any thread
+	//adds event to queue once when passes -- or if early, as soon as nothing queued outranks it, should that be sooner;
+	//a deadline rather than a start time
+	timer_id schedule_event(game_event* e, std::chrono::steady_clock::time_point when, bool early = false);
+	bool cancel_event(timer_id id);						//deletes scheduled event before it is due; false if it is gone
+	bool wait_events(std::chrono::steady_clock::time_point until =
+		std::chrono::steady_clock::time_point::max());	//sleeps until an event can run, or until; false if none can
 	bool next_event();									//replaces current event with event at top of queue; pops queue
 	void run_events();									//runs all events in the gameplay loop
 	void clear_events();								//clears event queue
 	int top_prio() const;								//returns type of event at top of queue; returns -1 if queue is empty
+	event_pool& get_pool() { return pool; }				//pool events of this handler are made in
+	std::uint64_t events_run() const { return ran; }
+	game_io& get_io() { return *io; }
+	void set_io(game_io& io_) { io = &io_; }			//console until set
+
+	static int highest(unsigned int levels);			//highest priority with its bit set in levels; -1 if none are
+
+	//latency -- recorded for every event run, always; may be read from any thread while it is
+	std::chrono::steady_clock::time_point dispatch_time() const;	//when running event was dispatched
+	void record_latency(int type, std::chrono::steady_clock::time_point start_t);	//called by start_event once an event is done
+	const latency_histogram& run_latency(int type) const;	//time from dispatch to completion of events of a type
+	const latency_histogram& input_latency(int type) const;	//time events of a type spent waiting on the player
+	void print_latency(std::ostream& out) const;		//p50/p90/p99/max of both, for every type that has run
+	void reset_latency();
+
+	//times a wait on the player, for the running event's input latency
+	class input_wait {
+		event_handler* const evh;
+		const std::chrono::steady_clock::time_point start_t;
+	public:
+		explicit input_wait(event_handler* evh_) : evh(evh_), start_t(std::chrono::steady_clock::now()) {}
+		~input_wait() {
+			evh->blocked += std::chrono::steady_clock::now() - start_t;
+			++evh->input_waits;
+		}
+		input_wait(const input_wait&) = delete;
+		input_wait& operator=(const input_wait&) = delete;
+	};
 };
  
 
@@ -60,12 +151,17 @@ public:
 //--------------------------
 
 //event base class
-class game_event {
+//events posted from other threads wait in event_handler's mpsc_queue, linked through their mpsc_node
+//events scheduled for later wait in its timing_wheel, as a wheel_node
+class game_event : private mpsc_node, private wheel_node {
 protected:
 	event_handler* const evh;							//pointer to event handler
 	room_handler* const rh;								//pointer to room handler
 	int priority;										//priority value
 	void (room_handler::*pNotify)();					//pointer to notification function
+	game_event* next;									//event queued behind this one at the same priority
+
+	friend class event_handler;
 
 	game_event(event_handler* evh_, room_handler* rh_, int prio, 
 		void (room_handler::* pNotify_)() = nullptr);
@@ -82,9 +178,62 @@ public:
 
 	enum PRIORITY { ROOM_OVER, ROOM, SPAWN, COMBAT, FEEDBACK, INPUT };	//low to high priorities, named by types of events
 
+	//concrete event classes, for telling them apart in traces and latency histograms -- events of other classes are OTHER_TYPE
+	enum TYPE { GAME_INTRO_TYPE, TURN_OVER_TYPE, ROOM_OVER_TYPE, COMBAT_EVENT_TYPE, NON_COMBAT_EVENT_TYPE,
+		ENEMY_SPAWN_TYPE, ENEMY_ATTACK_TYPE, ENEMY_DEFEND_TYPE, ENEMY_DIE_TYPE, PLAYER_ATTACK_TYPE, PLAYER_MISS_TYPE,
+		PLAYER_DODGE_TYPE, PLAYER_DEFEND_TYPE, PLAYER_EXP_TYPE, PLAYER_LEVELUP_TYPE, PLAYER_DIE_TYPE,
+		PLAYER_CONTINUE_TYPE, PLAYER_START_TYPE, PLAYER_QUIT_TYPE, OTHER_TYPE, TYPES };
+
+	//events live in their handler's pool -- made with new (evh) event(evh, ...), freed with delete as usual
+	//threads other than the one running events cannot touch the pool, so make events to post with plain new
+	static void* operator new(std::size_t size, event_handler* evh_);	//throws std::bad_alloc if evh_ is null
+	static void* operator new(std::size_t size);						//from the heap -- for post_event
+	static void operator delete(void* ptr, event_handler* evh_);		//frees event whose ctor threw
+	static void operator delete(void* ptr);
+
 	virtual ~game_event() {};
+	virtual int get_type() const { return OTHER_TYPE; }
+	const char* get_name() const { return type_name(get_type()); }
+	static const char* type_name(int type);				//name of event class type stands for
 	void start_event();									//pops top event and puts it on curr_event
 	int get_prio() const;								//just gets priority
+	virtual bool partial(double) { return false; }		//scales event by typing accuracy of a near miss; false if event has no partial form
+};
+
+//---------------------
+//----OUTCOME CLASS----
+//---------------------
+
+//event an input event leads to, built only once the player's typing picks it
+//holds the event's type and ctor arguments in place, rather than the event -- so the outcome not taken
+//is never allocated, and there is nothing to free if the input event is cleared before it runs
+class outcome {
+	static const std::size_t CAPACITY = 6 * sizeof(void*);	//room for the most ctor arguments any outcome takes
+
+	alignas(void*) unsigned char maker[CAPACITY];		//lambda building event from the arguments it captured
+	game_event* (*build)(const void* maker_);			//calls maker
+	bool partial_form;									//whether event overrides game_event::partial
+
+	template<class F>
+	outcome(const F& maker_, bool partial_form_) : build(&call<F>), partial_form(partial_form_) {
+		static_assert(sizeof(F) <= CAPACITY, "outcome arguments do not fit!");
+		static_assert(std::is_trivially_copyable<F>::value, "outcome arguments must be trivially copyable!");
+		new (maker) F(maker_);
+	}
+
+	template<class F>
+	static game_event* call(const void* maker_) { return (*static_cast<const F*>(maker_))(); }
+
+public:
+	//outcome building an E from ctor arguments evh_, args...
+	template<class E, class... Args>
+	static outcome of(event_handler* evh_, Args... args) {
+		return outcome([=]() -> game_event* { return new (evh_) E(evh_, args...); },
+			!std::is_same<decltype(&E::partial), bool (game_event::*)(double)>::value);
+	}
+
+	game_event* make() const { return build(maker); }	//builds event, in its handler's pool
+	bool has_partial() const { return partial_form; }	//whether event has a partial form -- see game_event::partial
 };
 
 //enemy event base class
@@ -115,11 +264,11 @@ protected:
 class input_event : public game_event {
 protected:
 	word_handler* const wh;									//pointer to word handler
-	game_event* pPassEvent;								//pointer to pass event
-	game_event* pFailEvent;								//pointer to fail event
+	outcome pass_outcome;								//event typing right leads to
+	outcome fail_outcome;								//event typing wrong leads to
 
 	input_event(event_handler* evh_, room_handler* rh_, word_handler* wh_,
-		game_event* pPassEvent_, game_event* pFailEvent_, int prio = INPUT);				
+		const outcome& pass_outcome_, const outcome& fail_outcome_, int prio = INPUT);				
 	void run_event() = 0;
 };
 
@@ -127,15 +276,6 @@ protected:
 //----GAMESTATE/ROOM EVENT CLASSES----
 //------------------------------------
 
-//loads relevant data for game -- called once at beginning of game
-class game_load : public game_event {
-	word_handler* const wh;
-public: 
-	game_load(event_handler* evh_, room_handler* rh_, word_handler* wh_,
-		int prio = INPUT);
-	void run_event();
-};
-
 //prints intro and checks if player wants to start/quit
 class game_intro : public game_event {
 	word_handler* const wh;
@@ -144,6 +284,7 @@ public:
 	game_intro(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
 		player* p_,	int prio = INPUT);
 	void run_event();
+	int get_type() const { return GAME_INTRO_TYPE; }
 };
 
 //notifies room_handler that turn is over
@@ -152,6 +293,7 @@ public:
 	turn_over(event_handler* evh_, room_handler* rh_, int prio = ROOM,
 		void (room_handler::* pNotify_)() = &room_handler::turnOver);
 	void run_event();
+	int get_type() const { return TURN_OVER_TYPE; }
 };
 
 //notifies room_handler that room is over
@@ -161,6 +303,7 @@ public:
 	room_over(event_handler* evh_, room_handler* rh_, enemy_handler* enh_, 
 		int prio = ROOM_OVER, void (room_handler::* pNotify_)() = &room_handler::room_over);
 	void run_event();
+	int get_type() const { return ROOM_OVER_TYPE; }
 };
 
 //---------------------------
@@ -169,11 +312,19 @@ public:
 
 class combat_event : public input_event {
 	enemy_handler* const enh;
+	outcome strike_outcome;		//enemy's strike, scheduled once the word is shown -- only if patience is not 0
+	int patience;				//milliseconds from the word being shown to the strike, cutting the word short
 public:
+	static constexpr double NEAR_MISS = 0.6;	//least accuracy that still earns partial credit in graded mode
+
 	combat_event(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
-		enemy_handler* enh,	game_event* pPassEvent_, game_event* pFailEvent_,
+		enemy_handler* enh,	const outcome& pass_outcome_, const outcome& fail_outcome_,
 		int prio = INPUT);
+	combat_event(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
+		enemy_handler* enh,	const outcome& pass_outcome_, const outcome& fail_outcome_,
+		const outcome& strike_outcome_, int patience_, int prio = INPUT);
 	void run_event();
+	int get_type() const { return COMBAT_EVENT_TYPE; }
 };
 
 class non_combat_event : public input_event {
@@ -181,9 +332,10 @@ class non_combat_event : public input_event {
 	std::string fail;
 public: 
 	non_combat_event(event_handler* evh_, room_handler* rh_, word_handler* wh_,
-		game_event* pPassEvent_, game_event* pFailEvent_, 
+		const outcome& pass_outcome_, const outcome& fail_outcome_, 
 		std::string pass_ = "Yes", std::string fail_ = "No", int prio = INPUT);
 	void run_event();
+	int get_type() const { return NON_COMBAT_EVENT_TYPE; }
 };
 
 //---------------------------
@@ -200,6 +352,7 @@ public:
 		enemy_handler* enh_, int prio = SPAWN, 
 		void (room_handler::* pNotify_)() = &room_handler::enemySpawn);
 	void run_event();
+	int get_type() const { return ENEMY_SPAWN_TYPE; }
 };
 
 //enemy attack event
@@ -212,17 +365,21 @@ public:
 	enemy_attack(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
 		enemy_handler* enh_, player* p_, int prio = COMBAT);
 	void run_event();
+	int get_type() const { return ENEMY_ATTACK_TYPE; }
 };
 
 //enemy defense event
 class enemy_defend : public enemy_event
 {
 	player* const p;		//pointer to player
+	double accuracy;		//fraction of player's attack that lands
 public: 
 	enemy_defend(event_handler* evh_, room_handler* rh_, enemy_handler* enh_, 
 		player* p_, int prio = FEEDBACK,
 		void (room_handler::* pNotify_)() = &room_handler::playerAttack);
 	void run_event();
+	int get_type() const { return ENEMY_DEFEND_TYPE; }
+	bool partial(double accuracy_);			//glancing blow
 };
 
 //enemy death event
@@ -234,6 +391,7 @@ public:
 		player* p_, int prio = FEEDBACK,
 		void (room_handler::* pNotify_)() = &room_handler::enemyDie);
 	void run_event();
+	int get_type() const { return ENEMY_DIE_TYPE; }
 };
 
 //----------------------------
@@ -249,6 +407,7 @@ public:
 	player_attack(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
 		enemy_handler* enh_, player* p_, int prio = COMBAT);
 	void run_event();
+	int get_type() const { return PLAYER_ATTACK_TYPE; }
 };
 
 //player dodge event
@@ -258,6 +417,7 @@ public:
 	player_miss(event_handler* evh_, room_handler* rh_, player* p_, 
 		int prio = FEEDBACK);
 	void run_event();
+	int get_type() const { return PLAYER_MISS_TYPE; }
 };
 
 //player dodge event
@@ -267,6 +427,7 @@ public:
 	player_dodge(event_handler* evh_, room_handler* rh_, player* p_, 
 		int prio = FEEDBACK, void (room_handler::* pNotify_)() = &room_handler::playerDodge);
 	void run_event();
+	int get_type() const { return PLAYER_DODGE_TYPE; }
 };
 
 //player defense event
@@ -275,10 +436,13 @@ class player_defend : public player_event
 	word_handler* const wh;
 	enemy_handler* const enh;
 	int dmg;                          //enemy attack value
+	bool grazed;                      //whether player partly dodged
 public:
 	player_defend(event_handler* evh_, room_handler* rh_, word_handler* wh_, 
 		enemy_handler* enh_, player* p_, int dmg_, int prio = FEEDBACK);
 	void run_event();
+	int get_type() const { return PLAYER_DEFEND_TYPE; }
+	bool partial(double accuracy);    //partial dodge
 };
 
 //player gain exp event
@@ -289,6 +453,7 @@ public:
 	player_exp(event_handler* evh_, room_handler* rh_, player* p_, 
 		int exp_, int prio = FEEDBACK);
 	void run_event();
+	int get_type() const { return PLAYER_EXP_TYPE; }
 };
 
 //player level up event
@@ -298,6 +463,7 @@ public:
 	player_levelup(event_handler* evh_, room_handler* rh_, player* p_, 
 		int prio = FEEDBACK);
 	void run_event();
+	int get_type() const { return PLAYER_LEVELUP_TYPE; }
 };
 
 //player death event
@@ -310,6 +476,7 @@ public:
 		enemy_handler* enh_, player* p_, int prio = FEEDBACK,
 		void (room_handler::* pNotify_)() = &room_handler::playerDie);
 	void run_event();
+	int get_type() const { return PLAYER_DIE_TYPE; }
 };
 
 //player continue event
@@ -320,6 +487,7 @@ public:
 	player_continue(event_handler* evh_, room_handler* rh_, enemy_handler* enh_,
 		player* p_, int prio = FEEDBACK);
 	void run_event();
+	int get_type() const { return PLAYER_CONTINUE_TYPE; }
 };
 
 //player start event
@@ -329,6 +497,7 @@ public:
 	player_start(event_handler* evh_, room_handler* rh_, player* p_,
 		int prio = INPUT);
 	void run_event();
+	int get_type() const { return PLAYER_START_TYPE; }
 };
 
 
@@ -339,6 +508,7 @@ public:
 	player_quit(event_handler* evh_, room_handler* rh_,	player* p_, 
 		int prio = INPUT);
 	void run_event();
+	int get_type() const { return PLAYER_QUIT_TYPE; }
 };
 
 /*todo
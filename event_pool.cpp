@@ -0,0 +1,83 @@
+/*
+* Justin W Li
+* event_pool.cpp
+* event memory pool function implementations
+*/
+
+#include "event_pool.h"
+#include <new>	//::operator new, ::operator delete
+
+//events run from about 100 to 320 bytes -- input events, holding two outcomes, are the largest, and a combat with
+//the enemy's strike to schedule holds three; the header takes up the first 16 of each block
+const std::size_t event_pool::BLOCK_SIZES[event_pool::CLASSES] = { 128, 160, 256, 320, 384 };
+
+//ctor
+event_pool::event_pool() : free_lists(), slabs() {}
+
+//dtor
+event_pool::~event_pool() {
+	for (void* slab : slabs)
+		::operator delete(slab);
+}
+
+//carves a new slab into blocks of size class, and links them into its free list
+void event_pool::refill(std::size_t size_class) {
+	slabs.reserve(slabs.size() + 1);		//so pushing the slab below cannot throw and lose it
+	char* slab = static_cast<char*>(::operator new(SLAB_SIZE));
+	slabs.push_back(slab);
+
+	const std::size_t block = BLOCK_SIZES[size_class];
+	for (std::size_t offset = 0; offset + block <= SLAB_SIZE; offset += block)
+	{
+		free_block* b = reinterpret_cast<free_block*>(slab + offset);
+		b->next = free_lists[size_class];
+		free_lists[size_class] = b;
+	}
+}
+
+//pops a block off the free list of the smallest class that fits
+void* event_pool::allocate(std::size_t size) {
+	const std::size_t needed = size + sizeof(header);
+	std::size_t size_class = 0;
+	while (size_class < CLASSES && BLOCK_SIZES[size_class] < needed)
+		++size_class;
+
+	if (size_class == CLASSES)
+		return allocate_heap(size);			//too big to pool
+
+	if (free_lists[size_class] == nullptr)
+		refill(size_class);
+	void* block = free_lists[size_class];
+	free_lists[size_class] = free_lists[size_class]->next;
+
+	header* h = static_cast<header*>(block);
+	h->pool = this;
+	h->size_class = size_class;
+	return h + 1;
+}
+
+//block from the heap with a header of its own, so release frees it like any other
+void* event_pool::allocate_heap(std::size_t size) {
+	header* h = static_cast<header*>(::operator new(size + sizeof(header)));
+	h->pool = nullptr;
+	h->size_class = CLASSES;
+	return h + 1;
+}
+
+//pushes block back on its free list
+void event_pool::release(void* ptr) {
+	if (ptr == nullptr)
+		return;
+
+	header* h = static_cast<header*>(ptr) - 1;
+	if (h->size_class == CLASSES)
+	{
+		::operator delete(h);
+		return;
+	}
+
+	event_pool* pool = h->pool;
+	free_block* b = reinterpret_cast<free_block*>(h);
+	b->next = pool->free_lists[h->size_class];
+	pool->free_lists[h->size_class] = b;
+}
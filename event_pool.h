@@ -0,0 +1,55 @@
+/*
+* Justin W Li
+* event_pool.h
+* event memory pool class definition
+*/
+
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <cstddef>	//std::size_t, std::max_align_t
+#include <vector>	//std::vector
+
+//------------------------
+//----EVENT POOL CLASS----
+//------------------------
+
+//fixed-size blocks for events, carved out of slabs and recycled through one free list per size class
+//each event_handler has its own, so a turn's events reuse the blocks the last turn's gave back instead of going to the heap
+//every block starts with a header naming its pool, so a block can be given back knowing nothing but its address
+class event_pool {
+public:
+	static const std::size_t CLASSES = 5;	//number of size classes
+	static const std::size_t BLOCK_SIZES[CLASSES];	//bytes each size class holds, header included
+
+private:
+	//sits just before every block handed out
+	struct alignas(std::max_align_t) header {
+		event_pool* pool;					//pool block came from
+		std::size_t size_class;				//free list block goes back to; CLASSES if it came from the heap
+	};
+
+	//unused block, linked into its free list
+	struct free_block {
+		free_block* next;
+	};
+
+	static const std::size_t SLAB_SIZE = 4096;	//bytes carved up at a time
+
+	free_block* free_lists[CLASSES];		//unused blocks of each size class
+	std::vector<void*> slabs;				//every slab carved, freed with pool
+
+	void refill(std::size_t size_class);	//carves a new slab into blocks of size class
+
+public:
+	event_pool();
+	~event_pool();							//frees every slab -- events still alive are gone with them
+	event_pool(const event_pool&) = delete;
+	event_pool& operator=(const event_pool&) = delete;
+
+	void* allocate(std::size_t size);		//block for an object of size bytes -- from the heap if no class is large enough
+	static void* allocate_heap(std::size_t size);	//block from the heap, for threads that do not own a pool
+	static void release(void* ptr);			//gives block back to pool it came from
+};
+
+#endif
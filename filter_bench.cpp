@@ -0,0 +1,166 @@
+/*
+* Justin W Li
+* filter_bench.cpp
+* checks word_filter against a plain search of every pattern, then times how much a blocklist adds to compiling a
+* word list -- by default 400000 random words and 10000 random patterns
+* usage: filter_bench [rounds] [words blocklist]
+*	rounds -- passes timed; the fastest is reported (default 5)
+*	words, blocklist -- files to time instead of random ones
+* exits with 1 if the filter and the plain search disagree on any word checked
+*/
+
+#include "word_bank.h"
+#include "word_filter.h"
+#include "mapped_file.h"
+#include "rng.h"
+
+#include <chrono>		//std::chrono::steady_clock
+#include <cstdio>		//std::printf, std::fputs
+#include <cstdlib>		//std::strtoul
+#include <string>		//std::string
+#include <vector>		//std::vector
+
+//random word of min to max letters, an eighth of them upper case
+static std::string random_word(rng& gen, std::size_t min, std::size_t max) {
+	std::string w(min + static_cast<std::size_t>(gen.bounded(max - min + 1)), ' ');
+	for (char& c : w)
+		c = static_cast<char>((gen.bounded(8) == 0 ? 'A' : 'a') + gen.bounded(26));
+	return w;
+}
+
+//whether pattern matches word, straight from the blocklist rules -- no automaton
+static bool plain_blocks(std::string p, const std::string& word) {
+	const bool at_start = p[0] == '^';
+	if (at_start)
+		p.erase(0, 1);
+	const bool at_end = p.back() == '$';
+	if (at_end)
+		p.pop_back();
+
+	auto upper = [](char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c; };
+	for (std::size_t at = 0; at + p.size() <= word.size(); ++at)
+	{
+		if ((at_start && at != 0) || (at_end && at + p.size() != word.size()))
+			continue;
+		std::size_t i = 0;
+		while (i < p.size() && upper(p[i]) == upper(word[at + i]))
+			++i;
+		if (i == p.size())
+			return true;
+	}
+	return false;
+}
+
+//ms to run fn -- fastest of rounds
+template <typename Fn>
+static double time_best(unsigned long rounds, Fn fn) {
+	double best = 0;
+	for (unsigned long round = 0; round < rounds; ++round)
+	{
+		std::chrono::steady_clock::time_point start_t = std::chrono::steady_clock::now();
+		fn();
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_t).count();
+		if (round == 0 || ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned long rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5;
+	rng gen(1);
+
+	try {
+		//random word list, and a blocklist of 4 to 6 letter pieces -- a tenth anchored at the start, a tenth at the
+		//end, and one in twenty whole words
+		std::string text, blocklist = "# random blocklist\r\n";
+		std::vector<std::string> patterns;
+		for (unsigned long i = 0; i < 400000; ++i)
+			text += random_word(gen, 3, 14) + '\n';
+		for (unsigned long i = 0; i < 10000; ++i)
+		{
+			std::string p = random_word(gen, 4, 6);
+			const std::uint64_t anchor = gen.bounded(20);
+			if (anchor < 2)
+				p = '^' + p;
+			else if (anchor < 4)
+				p += '$';
+			else if (anchor < 5)
+				p = '^' + p + '$';
+			patterns.push_back(p);
+			blocklist += p + "\r\n";
+		}
+
+		//every pattern against a sample of words, some with a pattern planted at the start, end or middle -- the
+		//plain search is too slow for all of them
+		word_filter filter;
+		filter.build(blocklist.data(), blocklist.size());
+		unsigned long blocked = 0, wrong = 0;
+		const unsigned long SAMPLE = 4000;
+		for (unsigned long i = 0; i < SAMPLE; ++i)
+		{
+			std::string w = random_word(gen, 1, 10);
+			if (gen.bounded(2) == 0)
+			{
+				std::string p = patterns[static_cast<std::size_t>(gen.bounded(patterns.size()))];
+				if (p[0] == '^')
+					p.erase(0, 1);
+				if (p.back() == '$')
+					p.pop_back();
+				const std::size_t at = static_cast<std::size_t>(gen.bounded(w.size() + 1));
+				w.insert(gen.bounded(3) == 0 ? 0 : gen.bounded(2) == 0 ? w.size() : at, p);
+			}
+			bool want = false;
+			for (const std::string& p : patterns)
+			{
+				if (plain_blocks(p, w))
+				{
+					want = true;
+					break;
+				}
+			}
+			blocked += want ? 1 : 0;
+			if (filter.blocks(w) != want && ++wrong <= 5)
+				std::printf("mismatch: \"%s\" -- want %s\n", w.c_str(), want ? "blocked" : "kept");
+		}
+		std::printf("%lu words checked against %zu patterns, %lu blocked, %lu mismatches\n", SAMPLE, patterns.size(),
+			blocked, wrong);
+
+		//files given replace the random ones for the timing
+		mapped_file words_file, blocklist_file;
+		if (argc > 3)
+		{
+			if (!words_file.open(argv[2]) || !blocklist_file.open(argv[3]))
+				throw "filter_bench: failed to open file!\n";
+			text.assign(words_file.data(), words_file.size());
+			blocklist.assign(blocklist_file.data(), blocklist_file.size());
+		}
+
+		//the filter is only built, and the list only scanned, when words.gwb has to be recompiled
+		std::size_t words = 0, kept = 0;
+		const double build_ms = time_best(rounds, [&filter, &blocklist]() {
+			filter.build(blocklist.data(), blocklist.size());
+		});
+		const double plain_ms = time_best(rounds, [&text, &words]() {
+			word_bank bank;
+			bank.build(text.data(), text.size());
+			words = bank.size();
+		});
+		const double filtered_ms = time_best(rounds, [&text, &filter, &kept]() {
+			word_bank bank;
+			bank.build(text.data(), text.size(), 0, &filter);
+			kept = bank.size();
+		});
+
+		std::printf("%zu words, %zu kept:\n", words, kept);
+		std::printf("  build filter       %8.2f ms\n", build_ms);
+		std::printf("  compile            %8.2f ms\n", plain_ms);
+		std::printf("  compile, filtered  %8.2f ms  (+%.2f ms)\n", filtered_ms, filtered_ms - plain_ms);
+		return wrong == 0 ? 0 : 1;
+	}
+	catch (const char* e) {
+		std::fputs(e, stderr);
+		return 1;
+	}
+}
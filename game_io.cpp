@@ -0,0 +1,85 @@
+/*
+* Justin W Li
+* game_io.cpp
+* game input/output function implementations
+*/
+
+#include "game_io.h"
+#include "terminal_io.h"
+#include <iostream>		//std::cout, std::cin
+#include <utility>		//std::move
+
+//-------------------------------
+//----GAME IO IMPLEMENTATIONS----
+//-------------------------------
+
+//ctor -- a stream without a buffer is always bad, so everything written to discard is skipped right away
+game_io::game_io(std::ostream* text_) : discard(nullptr), typed(), text(text_ != nullptr ? text_ : &discard) {}
+
+//the terminal itself, if there is one to put in raw mode; std::cin otherwise, so piped games read as before
+game_io& game_io::console() {
+#ifndef _WIN32
+	if (terminal_io::available())
+	{
+		static terminal_io term;
+		return term;
+	}
+#endif
+	static console_io io;
+	return io;
+}
+
+//----------------------------------
+//----CONSOLE IO IMPLEMENTATIONS----
+//----------------------------------
+
+console_io::console_io() : game_io(&std::cout) {}
+console_io::console_io(std::ostream* text_) : game_io(text_) {}
+
+void console_io::read_word(std::string& typed, std::string_view, std::chrono::steady_clock::time_point) {
+	std::cin >> typed;
+}
+void console_io::read_choice(std::string& typed, std::string_view, std::string_view) { std::cin >> typed; }
+
+void console_io::wait_enter() {
+	while (std::cin.get() != '\n');
+}
+
+null_io::null_io() : console_io(nullptr) {}
+
+//-----------------------------------
+//----SCRIPTED IO IMPLEMENTATIONS----
+//-----------------------------------
+
+static bool space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+//ctor -- trims trailing space, so done() is true as soon as the last word is read
+scripted_io::scripted_io(std::string script_, std::ostream* text_) : game_io(text_), script(std::move(script_)), pos(0) {
+	while (!script.empty() && space(script.back()))
+		script.pop_back();
+}
+
+std::string_view scripted_io::next_word() {
+	while (pos < script.size() && space(script[pos]))
+		++pos;
+	const std::size_t start = pos;
+	while (pos < script.size() && !space(script[pos]))
+		++pos;
+	return std::string_view(script).substr(start, pos - start);
+}
+
+void scripted_io::read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point) {
+	std::string_view word = next_word();
+	if (word == "*")
+		word = target;
+	typed.assign(word.data(), word.size());		//out of script, an empty word misses
+}
+
+void scripted_io::read_choice(std::string& typed, std::string_view pass, std::string_view fail) {
+	std::string_view word = next_word();
+	if (word == "*")
+		word = pass;
+	else if (word.empty())
+		word = fail;							//out of script, turn choice down
+	typed.assign(word.data(), word.size());
+}
@@ -0,0 +1,105 @@
+/*
+* Justin W Li
+* game_io.h
+* game input/output class definitions
+*/
+
+#ifndef GAME_IO_H
+#define GAME_IO_H
+
+#include <chrono>		//std::chrono::steady_clock
+#include <cstddef>		//std::size_t
+#include <ostream>		//std::ostream
+#include <string>		//std::string
+#include <string_view>	//std::string_view
+
+//---------------------
+//----GAME IO CLASS----
+//---------------------
+
+//where events print to and read the player's typing from
+//events never touch std::cout or std::cin themselves, so a game can be played by a script, with nothing printed
+class game_io {
+	std::ostream discard;								//stream with no buffer -- writing to it does nothing
+	std::string typed;									//what the player typed for the last word
+
+protected:
+	std::ostream* text;									//where game's text goes
+
+public:
+	explicit game_io(std::ostream* text_);				//text_ of nullptr throws all text away
+	virtual ~game_io() {}
+	game_io(const game_io&) = delete;
+	game_io& operator=(const game_io&) = delete;
+
+	std::ostream& out() { return *text; }				//stream game's text goes to
+	std::string& typing() {								//empty string to read a word into -- kept between turns,
+		typed.clear();									//so a long word only allocates the first time one that
+		return typed;									//long is typed
+	}
+
+	virtual void read_word(std::string& typed, std::string_view target,
+		std::chrono::steady_clock::time_point deadline) = 0;	//player's try at typing target -- late is a miss
+	virtual void read_choice(std::string& typed, std::string_view pass,
+		std::string_view fail) = 0;						//player's try at typing pass or fail
+	virtual void wait_enter() = 0;						//waits for player to press enter
+	virtual std::chrono::steady_clock::time_point now() {
+		return std::chrono::steady_clock::now();		//clock typing is timed on -- a bot can keep its own
+	}
+
+	static game_io& console();							//console backend, shared by everything not given another
+};
+
+//------------------------
+//----CONSOLE IO CLASS----
+//------------------------
+
+//reads std::cin; prints to std::cout
+//reading waits for enter however long it takes -- lateness is only found out afterwards
+class console_io : public game_io {
+protected:
+	explicit console_io(std::ostream* text_);
+
+public:
+	console_io();
+
+	void read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point deadline);
+	void read_choice(std::string& typed, std::string_view pass, std::string_view fail);
+	void wait_enter();
+};
+
+//---------------------
+//----NULL IO CLASS----
+//---------------------
+
+//reads std::cin, but prints nothing -- for piping a prepared game through as fast as it goes
+class null_io : public console_io {
+public:
+	null_io();
+};
+
+//-------------------------
+//----SCRIPTED IO CLASS----
+//-------------------------
+
+//plays words from a script instead of a player -- for tests, benchmarks and bots
+//script is words separated by whitespace; "*" types whatever word was asked for (the first one, in a choice)
+//once the script runs out, every word is missed and every choice turned down, so any script ends in the player
+//dying and quitting
+class scripted_io : public game_io {
+	std::string script;
+	std::size_t pos;									//start of next word in script
+
+	std::string_view next_word();						//next word of script; empty once it runs out
+
+public:
+	explicit scripted_io(std::string script_, std::ostream* text_ = nullptr);	//prints nothing unless given text_
+
+	void read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point deadline);
+	void read_choice(std::string& typed, std::string_view pass, std::string_view fail);
+	void wait_enter() {}
+	bool done() const { return pos >= script.size(); }	//returns whether script has run out
+	void restart() { pos = 0; }							//plays script again from its first word
+};
+
+#endif
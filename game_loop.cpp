@@ -5,25 +5,86 @@
 */
 
 #include "game_loop.h"
+#include <chrono>	//std::chrono::system_clock, std::chrono::steady_clock
+#include <csignal>	//std::signal, std::sig_atomic_t
+#include <cstdio>	//std::fputs
 
-game_loop::game_loop() try : evh(), enh(), rh(), wh(), p() {} //just call default ctors
+//set by SIGHUP, until a turn starts the reload it asks for
+static volatile std::sig_atomic_t reload_asked = 0;
+
+static void on_hangup(int) {
+	reload_asked = 1;
+}
+
+//seed for sessions that were not given one
+static std::uint64_t clock_seed() {
+	return static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())
+		^ static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+game_loop::game_loop(word_handler::backend storage, word_handler::ranking order, std::size_t memory_cap) :
+	game_loop(clock_seed(), storage, order, memory_cap) {}
+
+game_loop::game_loop(std::uint64_t seed_, word_handler::backend storage, word_handler::ranking order,
+	std::size_t memory_cap) try :
+	seed(seed_), turns(0), gen(seed_), evh(), enh(&gen), rh(), wh(&gen, storage, order, memory_cap), p(),
+	eng({ &rh, &wh, &enh, &p, &game_io::console() })
+#ifdef GOBLINS_COROUTINES
+	, coro({ &rh, &wh, &enh, &p, &game_io::console() })
+#endif
+	, reloading(false), latency_report(false)
+{}
 catch(game_event::EVENT_EXCEPTION& e) {
 	throw e.what();
 }
-//gameplay loop function
-void game_loop::run() {
+//new session on the words already loaded -- plays out exactly as a game_loop built with seed_ would
+void game_loop::restart(std::uint64_t seed_) {
+	seed = seed_;
+	gen.seed(seed_);
+	evh.clear_events();
+	eng.clear_events();
+	enh.reset();
+	rh.restart();
+	p = player();
+	wh.reshuffle();
+}
 
-	//add game load events
-	try {
-		evh.add_event(new game_load(&evh, &rh, &wh));
+//a terminal's hang-up signal is the usual way to ask a running program to reread its files
+void game_loop::reload_on_hangup() {
+#ifdef SIGHUP
+	std::signal(SIGHUP, on_hangup);
+#endif
+}
+
+//a reload asked for while one is still running waits for the next turn; the old words stay in play until the new
+//ones are ready, or for good if they fail to load
+void game_loop::check_reload() {
+	if (reload_asked != 0 && wh.reload())
+	{
+		reload_asked = 0;
+		reloading = true;
 	}
-	catch (std::bad_alloc& e) { //check for alloc failure
-		throw e.what();
+	if (reloading && wh.reloaded())
+	{
+		reloading = false;
+		try {
+			wh.wait_reload();
+			evh.get_io().out() << "The words have been reloaded.\n";
+		}
+		catch (const char* e) {
+			std::fputs(e, stderr);
+		}
 	}
+}
+
+//gameplay loop function
+void game_loop::run() {
+
+	//word bank is already loading in the background (see word_handler ctor)
 
 	//add game intro events
 	try {
-		evh.add_event(new game_intro(&evh, &rh, &wh, &p));
+		evh.add_event(new (&evh) game_intro(&evh, &rh, &wh, &p));
 	}
 	catch (std::bad_alloc& e) { //check for alloc failure
 		throw e.what();
@@ -31,9 +92,11 @@ void game_loop::run() {
 
 	while (p.alive())
 	{
+		check_reload();
+
 		//always add an event that ends the turn
 		try {
-			evh.add_event(new turn_over(&evh, &rh));
+			evh.add_event(new (&evh) turn_over(&evh, &rh));
 		}
 		catch (std::bad_alloc& e) { //check for alloc failure
 			throw e.what();
@@ -43,7 +106,7 @@ void game_loop::run() {
 		{
 			//spawn an enemy
 			try {
-				evh.add_event(new enemy_spawn(&evh, &rh, &enh));
+				evh.add_event(new (&evh) enemy_spawn(&evh, &rh, &enh));
 			}
 			catch (std::bad_alloc& e) { //check for alloc failure
 				throw e.what();
@@ -52,11 +115,11 @@ void game_loop::run() {
 
 		//check if there are enemies
 		if (!enh.empty()) {
-			//add combat functions
-			//spawn an enemy
+			//add combat functions -- with timed strikes, the player's word schedules the enemy's attack
 			try {
-				evh.add_event(new player_attack(&evh, &rh, &wh, &enh, &p));
-				evh.add_event(new enemy_attack(&evh, &rh, &wh, &enh, &p));
+				evh.add_event(new (&evh) player_attack(&evh, &rh, &wh, &enh, &p));
+				if (enh.patience() == 0)
+					evh.add_event(new (&evh) enemy_attack(&evh, &rh, &wh, &enh, &p));
 			}
 			catch (std::bad_alloc& e) { //check for alloc failure
 				throw e.what();
@@ -70,6 +133,55 @@ void game_loop::run() {
 
 		//run all events in the queue
 		evh.run_events();
+		++turns;
 	}
+
+	//printed once the last event is done, so its latency is in the table too
+	if (latency_report)
+		evh.print_latency(evh.get_io().out());
 }
 
+//gameplay loop function, on the flat event engine -- same turns as run()
+void game_loop::run_flat() {
+	eng.add_event(event_engine::game_intro());
+
+	while (p.alive())
+	{
+		check_reload();
+
+		//always add an event that ends the turn
+		eng.add_event(event_engine::turn_over());
+
+		//spawn an enemy if more can be spawned
+		if (rh.can_spawn())
+			eng.add_event(event_engine::enemy_spawn());
+
+		//add combat events if there are enemies
+		if (!enh.empty())
+		{
+			eng.add_event(event_engine::player_attack());
+			eng.add_event(event_engine::enemy_attack());
+		}
+
+		//run all events in the queue
+		eng.run_events();
+		++turns;
+	}
+}
+#ifdef GOBLINS_COROUTINES
+
+//gameplay loop function, on the coroutine engine -- same turns as run()
+void game_loop::run_coro() {
+	//the intro shares the first turn, as in run() -- a player who quits in it has still played that turn
+	if (!coro.run_intro())
+		++turns;
+
+	//a turn fights only if there was an enemy before it spawned one, as in run()
+	while (p.alive())
+	{
+		check_reload();
+		coro.run_turn(rh.can_spawn(), !enh.empty());
+		++turns;
+	}
+}
+#endif
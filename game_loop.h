@@ -5,24 +5,69 @@
 */
 
 #include "event_handler.h"
+#include "event_engine.h"
+#include "coro_engine.h"
 #include "enemy_handler.h"
 #include "room_handler.h"
 #include "word_handler.h"
 #include "player.h"
+#include "rng.h"
+
+#include <cstdint>	//std::uint64_t
 
 //runs the game loop
-//multiply inherits from all other handlers
-class game_loop : public event_handler, public enemy_handler,
-	public room_handler, public word_handler, public player 
+//owns one of each handler, all drawing from the session's generator
+class game_loop
 {
+	std::uint64_t seed;		//seed of session -- replaying it replays the session
+	std::uint64_t turns;	//turns played so far, over every session
+	rng gen;
 	event_handler evh;
 	enemy_handler enh;
 	room_handler rh;
 	word_handler wh;
 	player p;
+	event_engine eng;		//flat engine -- only used by run_flat
+#ifdef GOBLINS_COROUTINES
+	coro_engine coro;		//coroutine engine -- only used by run_coro
+#endif
+	bool reloading;			//whether a reload of words.txt was started and not reported on yet
+	bool latency_report;	//whether run prints latency once the game is over
+
+	void check_reload();	//starts a reload if one was asked for; reports one that finished
 
 public:
-	//ctor
-	game_loop();
+	//ctors
+	game_loop(word_handler::backend storage = word_handler::PACKED,
+		word_handler::ranking order = word_handler::BY_LENGTH, std::size_t memory_cap = 0);	//seeds from clock
+	explicit game_loop(std::uint64_t seed_, word_handler::backend storage = word_handler::PACKED,
+		word_handler::ranking order = word_handler::BY_LENGTH, std::size_t memory_cap = 0);
 	void run();
+	void run_flat();		//same game, with events dispatched by event_engine instead of event_handler
+#ifdef GOBLINS_COROUTINES
+	void run_coro();		//same game again, with each turn one coroutine -- needs C++20
+#endif
+	void restart(std::uint64_t seed_);	//starts over, as if built with seed_, without loading words again
+	std::uint64_t get_seed() const { return seed; }
+	void set_graded(bool graded) { wh.set_graded(graded); }	//partial credit for near misses
+	void set_strikes(bool strikes) { enh.set_strikes(strikes); }	//enemies strike a few seconds after each word is
+																	//shown, cutting it short
+	void set_latency_report(bool report) { latency_report = report; }	//prints each event type's latency once the game is
+																		//over -- run() only
+	const event_handler& get_events() const { return evh; }		//event handler run() plays on -- for its latency
+	bool reload_words() { return wh.reload(); }				//picks up a changed words.txt without a restart
+	static void reload_on_hangup();							//POSIX only -- SIGHUP reloads words.txt at the start of the
+															//next turn, in every game
+	void wait_words() const { wh.wait(); }					//blocks until word bank is loaded
+	void set_io(game_io& io) {								//plays through io instead of the console
+		evh.set_io(io);
+		eng.set_io(io);
+#ifdef GOBLINS_COROUTINES
+		coro.set_io(io);
+#endif
+	}
+	std::uint64_t events_run() const { return evh.events_run() + eng.events_run(); }
+	std::uint64_t turns_run() const { return turns; }		//turns played, on whichever engine
+	int room() const { return rh.get_room(); }				//number of room player is in
+	unsigned stage() const { return enh.get_stage(); }		//stage enemies spawn at
 };
\ No newline at end of file
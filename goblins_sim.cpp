@@ -0,0 +1,327 @@
+/*
+* Justin W Li
+* goblins_sim.cpp
+* plays many sessions with a modelled typist on every core, and prints how far they got, for balance tuning
+* usage: goblins_sim [sessions] [--threads=N] [--accuracy=A] [--wpm=W] [--spread=S] [--reaction=MS]
+*	[--continues=N] [--max-rooms=N] [--seed=N] [--graded] [--strikes] [--typing] [--flat-events]
+*	sessions -- number of sessions played (default 10000)
+*	--threads -- workers playing them (default one per core)
+*	--accuracy, --wpm, --spread, --reaction, --continues -- the typist (see bot_io::model)
+*	--max-rooms -- rooms a session may clear before the bot gives up on it (default 50)
+*	--seed -- seed of first session; session i is seeded with seed + i, so results never depend on --threads
+*	--graded, --strikes, --typing, --flat-events -- as in the game
+*/
+
+#include "game_loop.h"
+#include "bot_io.h"
+#include "work_pool.h"
+
+#include <chrono>		//std::chrono::steady_clock
+#include <cstdint>		//std::uint64_t
+#include <cstdio>		//std::printf, std::fprintf, std::fputs
+#include <cstdlib>		//std::strtod, std::strtoul, std::strtoull
+#include <cstring>		//std::strcmp, std::strncmp, std::strlen, std::strspn
+#include <memory>		//std::unique_ptr
+#include <string>		//std::string
+#include <string_view>	//std::string_view
+#include <vector>		//std::vector
+
+//-------------------
+//----STATS CLASS----
+//-------------------
+
+//bin i counts sessions, or deaths, at value i
+using histogram = std::vector<std::uint64_t>;
+
+static void add(histogram& h, std::size_t i, std::uint64_t n = 1) {
+	if (h.size() <= i)
+		h.resize(i + 1, 0);
+	h[i] += n;
+}
+
+static std::uint64_t total(const histogram& h) {
+	std::uint64_t sum = 0;
+	for (std::uint64_t n : h)
+		sum += n;
+	return sum;
+}
+
+//smallest value with at least q of the histogram's counts at or below it
+static std::size_t percentile(const histogram& h, double q) {
+	const double want = q * total(h);
+	std::uint64_t sum = 0;
+	for (std::size_t i = 0; i < h.size(); ++i)
+	{
+		sum += h[i];
+		if (sum > 0 && sum >= want)
+			return i;
+	}
+	return h.empty() ? 0 : h.size() - 1;
+}
+
+//what a worker saw -- merged once every session is done
+struct stats {
+	std::uint64_t sessions = 0;
+	std::uint64_t capped = 0;						//sessions given up on at --max-rooms
+	std::uint64_t events = 0;
+	double seconds = 0;								//time played, on the bots' clocks
+	histogram cleared;								//sessions by rooms cleared
+	histogram reached;								//sessions by rooms reached -- bin r counts those that got to room r
+	histogram deaths;								//deaths by room they happened in
+	std::vector<histogram> room_stage;				//[room] -- sessions by stage they entered room at
+	std::vector<histogram> stage_time;				//[stage] -- sessions by seconds until they first reached it
+
+	void merge(const stats& o) {
+		sessions += o.sessions;
+		capped += o.capped;
+		events += o.events;
+		seconds += o.seconds;
+		for (std::size_t i = 0; i < o.cleared.size(); ++i)
+			add(cleared, i, o.cleared[i]);
+		for (std::size_t i = 0; i < o.reached.size(); ++i)
+			add(reached, i, o.reached[i]);
+		for (std::size_t i = 0; i < o.deaths.size(); ++i)
+			add(deaths, i, o.deaths[i]);
+		if (room_stage.size() < o.room_stage.size())
+			room_stage.resize(o.room_stage.size());
+		for (std::size_t r = 0; r < o.room_stage.size(); ++r)
+			for (std::size_t i = 0; i < o.room_stage[r].size(); ++i)
+				add(room_stage[r], i, o.room_stage[r][i]);
+		if (stage_time.size() < o.stage_time.size())
+			stage_time.resize(o.stage_time.size());
+		for (std::size_t s = 0; s < o.stage_time.size(); ++s)
+			for (std::size_t i = 0; i < o.stage_time[s].size(); ++i)
+				add(stage_time[s], i, o.stage_time[s][i]);
+	}
+};
+
+//-------------------------
+//----WATCHED BOT CLASS----
+//-------------------------
+
+//bot that notes where the game is every time it is asked to type
+class watched_bot : public bot_io {
+	const game_loop* game;
+	stats* st;
+	int max_rooms;
+	int last_room;									//game's number for room it last saw; 0 before first word
+	int room;										//rooms it has seen, counting from 1
+	int top_stage;									//highest stage it has seen; -1 before first word
+	bool capped;
+
+	void look() {
+		//room_handler's own count goes up twice a room, as room_over is both run and notified -- count them here
+		if (game->room() != last_room)
+		{
+			last_room = game->room();
+			++room;
+			if (room > max_rooms)
+			{
+				capped = true;
+				give_up();
+				return;
+			}
+			add(st->reached, room);
+			if (st->room_stage.size() <= static_cast<std::size_t>(room))
+				st->room_stage.resize(room + 1);
+			add(st->room_stage[room], game->stage());
+		}
+		//stages can fall again -- only the first time each is reached counts
+		while (top_stage < static_cast<int>(game->stage()))
+		{
+			++top_stage;
+			if (st->stage_time.size() <= static_cast<std::size_t>(top_stage))
+				st->stage_time.resize(top_stage + 1);
+			add(st->stage_time[top_stage], static_cast<std::size_t>(elapsed()));
+		}
+	}
+
+public:
+	watched_bot(const model& m_, const game_loop* game_, stats* st_, int max_rooms_) :
+		bot_io(m_, 0), game(game_), st(st_), max_rooms(max_rooms_), last_room(0), room(0), top_stage(-1), capped(false) {}
+
+	void restart(std::uint64_t seed) {
+		bot_io::restart(seed);
+		last_room = 0;
+		room = 0;
+		top_stage = -1;
+		capped = false;
+	}
+
+	//session is over -- counts how far it got
+	void finish() {
+		++st->sessions;
+		if (capped)
+			++st->capped;
+		add(st->cleared, static_cast<std::size_t>(capped ? max_rooms : room - 1));
+		st->seconds += elapsed();
+	}
+
+	void read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point deadline) {
+		if (!gave_up())
+			look();
+		bot_io::read_word(typed, target, deadline);
+	}
+
+	void read_choice(std::string& typed, std::string_view pass, std::string_view fail) {
+		if (pass == "Yes" && !gave_up())			//died -- deaths after giving up are not the game's doing
+			add(st->deaths, static_cast<std::size_t>(room));
+		bot_io::read_choice(typed, pass, fail);
+	}
+};
+
+//one per thread -- a game with its own copy of the words, and the bot playing it
+struct worker {
+	game_loop game;
+	stats st;
+	watched_bot bot;
+
+	worker(const bot_io::model& m, int max_rooms, word_handler::ranking order, bool graded, bool strikes) :
+		game(0, word_handler::PACKED, order), st(), bot(m, &game, &st, max_rooms)
+	{
+		game.set_graded(graded);
+		game.set_strikes(strikes);
+		game.set_io(bot);
+	}
+};
+
+//value of flag "--name=value", or nullptr if arg is not that flag
+static const char* flag(const char* arg, const char* name) {
+	const std::size_t len = std::strlen(name);
+	if (std::strncmp(arg, name, len) == 0 && arg[len] == '=')
+		return arg + len + 1;
+	return nullptr;
+}
+
+//--------------
+//----OUTPUT----
+//--------------
+
+static void print(const stats& st, double real_secs, unsigned int threads) {
+	const double n = static_cast<double>(st.sessions);
+	std::printf("%llu sessions on %u threads in %.2f s -- %.0f sessions/s, %.0f events/s\n",
+		static_cast<unsigned long long>(st.sessions), threads, real_secs, n / real_secs, st.events / real_secs);
+	std::printf("mean session: %.1f s of play\n", st.seconds / n);
+	if (st.capped != 0)
+		std::printf("%llu sessions (%.1f%%) cleared --max-rooms and were stopped\n",
+			static_cast<unsigned long long>(st.capped), 100.0 * st.capped / n);
+
+	std::printf("\nrooms cleared: p10 %zu, p50 %zu, p90 %zu, p99 %zu\n", percentile(st.cleared, 0.10),
+		percentile(st.cleared, 0.50), percentile(st.cleared, 0.90), percentile(st.cleared, 0.99));
+	std::printf("%6s %9s %8s  %s\n", "rooms", "sessions", "share", "");
+	for (std::size_t i = 0; i < st.cleared.size(); ++i)
+	{
+		if (st.cleared[i] == 0)
+			continue;
+		const double share = st.cleared[i] / n;
+		std::printf("%6zu %9llu %7.2f%%  %s\n", i, static_cast<unsigned long long>(st.cleared[i]), 100 * share,
+			std::string(static_cast<std::size_t>(share * 50 + 0.5), '#').c_str());
+	}
+
+	std::printf("\n%6s %9s %10s %11s %14s\n", "room", "reached", "deaths", "per visit", "stage p10-p90");
+	for (std::size_t r = 1; r < st.reached.size(); ++r)
+	{
+		if (st.reached[r] == 0)
+			continue;
+		const std::uint64_t d = r < st.deaths.size() ? st.deaths[r] : 0;
+		const histogram& stage = st.room_stage[r];
+		std::printf("%6zu %9llu %10llu %11.3f %7zu-%zu\n", r, static_cast<unsigned long long>(st.reached[r]),
+			static_cast<unsigned long long>(d), static_cast<double>(d) / st.reached[r],
+			percentile(stage, 0.10), percentile(stage, 0.90));
+	}
+
+	std::printf("\n%6s %9s %8s %22s\n", "stage", "reached", "share", "seconds p10/p50/p90");
+	for (std::size_t s = 0; s < st.stage_time.size(); ++s)
+	{
+		const histogram& t = st.stage_time[s];
+		const std::uint64_t got = total(t);
+		std::printf("%6zu %9llu %7.2f%% %8zu/%zu/%zu\n", s, static_cast<unsigned long long>(got), 100.0 * got / n,
+			percentile(t, 0.10), percentile(t, 0.50), percentile(t, 0.90));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::uint64_t sessions = 10000;
+	unsigned int threads = 0;
+	bot_io::model m;
+	int max_rooms = 50;
+	std::uint64_t seed = 1;
+	bool graded = false;
+	bool strikes = false;
+	bool flat = false;
+	word_handler::ranking order = word_handler::BY_LENGTH;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* v;
+		if ((v = flag(argv[i], "--threads")) != nullptr)
+			threads = static_cast<unsigned int>(std::strtoul(v, nullptr, 10));
+		else if ((v = flag(argv[i], "--accuracy")) != nullptr)
+			m.accuracy = std::strtod(v, nullptr);
+		else if ((v = flag(argv[i], "--wpm")) != nullptr)
+			m.wpm = std::strtod(v, nullptr);
+		else if ((v = flag(argv[i], "--spread")) != nullptr)
+			m.spread = std::strtod(v, nullptr);
+		else if ((v = flag(argv[i], "--reaction")) != nullptr)
+			m.reaction_ms = std::strtod(v, nullptr);
+		else if ((v = flag(argv[i], "--continues")) != nullptr)
+			m.continues = static_cast<unsigned int>(std::strtoul(v, nullptr, 10));
+		else if ((v = flag(argv[i], "--max-rooms")) != nullptr)
+			max_rooms = static_cast<int>(std::strtoul(v, nullptr, 10));
+		else if ((v = flag(argv[i], "--seed")) != nullptr)
+			seed = std::strtoull(v, nullptr, 10);
+		else if (std::strcmp(argv[i], "--graded") == 0)
+			graded = true;
+		else if (std::strcmp(argv[i], "--strikes") == 0)
+			strikes = true;
+		else if (std::strcmp(argv[i], "--typing") == 0)
+			order = word_handler::BY_TYPING;
+		else if (std::strcmp(argv[i], "--flat-events") == 0)
+			flat = true;
+		else if (argv[i][0] != '\0' && argv[i][std::strspn(argv[i], "0123456789")] == '\0')
+			sessions = std::strtoull(argv[i], nullptr, 10);
+		else
+		{
+			//as in the game -- a mistyped flag would otherwise be read as 0 sessions
+			std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	try {
+		work_pool pool(threads);
+
+		//every worker loads words once, up front, and restarts its game for each session
+		std::vector<std::unique_ptr<worker>> workers;
+		for (unsigned int i = 0; i < pool.size(); ++i)
+			workers.emplace_back(new worker(m, max_rooms, order, graded, strikes));
+		for (const std::unique_ptr<worker>& w : workers)
+			w->game.wait_words();
+
+		std::chrono::steady_clock::time_point start_t = std::chrono::steady_clock::now();
+		pool.run(sessions, [&](unsigned int id, std::uint64_t index) {
+			worker& w = *workers[id];
+			w.game.restart(seed + index);
+			w.bot.restart(~(seed + index));		//bot's noise is its own, but still fixed by the session
+			const std::uint64_t events = w.game.events_run();
+			if (flat)
+				w.game.run_flat();
+			else
+				w.game.run();
+			w.st.events += w.game.events_run() - events;
+			w.bot.finish();
+		});
+		double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_t).count();
+
+		stats all;
+		for (const std::unique_ptr<worker>& w : workers)
+			all.merge(w->st);
+		if (all.sessions != 0)
+			print(all, secs, pool.size());
+	}
+	catch (const char* e) {
+		std::fputs(e, stderr);
+		return 1;
+	}
+	return 0;
+}
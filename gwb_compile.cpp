@@ -0,0 +1,47 @@
+/*
+* Justin W Li
+* gwb_compile.cpp
+* compiles words.txt into a binary word bank -- separate program from the game
+* usage: gwb_compile [words.txt] [words.gwb] [blocklist.txt]
+*	blocklist is used if it exists, as the game does; naming one requires it
+* also prints the bytes the bank takes packed and as a word graph, and which of the two Goblins --dawg keeps
+*/
+
+#include "word_bank.h"
+#include "word_dawg.h"
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+	const char* text_path = argc > 1 ? argv[1] : "words.txt";
+	const char* bank_path = argc > 2 ? argv[2] : "words.gwb";
+	const char* blocklist_path = argc > 3 ? argv[3] : (std::ifstream("blocklist.txt") ? "blocklist.txt" : nullptr);
+
+	if (!word_bank::compile_file(text_path, bank_path, 0, blocklist_path))
+	{
+		std::cerr << "gwb_compile: failed to compile " << text_path << " into " << bank_path << std::endl;
+		return 1;
+	}
+
+	word_bank bank;
+	bank.load(bank_path);
+	std::cout << "Compiled " << bank.size() << " words, up to " << bank.max_length()
+		<< " letters long, into " << bank_path << "." << std::endl;
+
+	//same choice word_handler makes for the DAWG backend
+	word_dawg dawg;
+	try {
+		dawg.build(bank);
+	}
+	catch (const char*) {
+		dawg.clear();
+	}
+	std::cout << "Packed bank: " << bank.memory() << " bytes. Word graph: ";
+	if (dawg.size() == bank.size())
+		std::cout << dawg.memory() << " bytes, " << dawg.nodes() << " nodes.";
+	else
+		std::cout << "too large to build.";
+	std::cout << " --dawg keeps the " << (dawg.replaces(bank) ? "word graph." : "packed bank.") << std::endl;
+	return 0;
+}
@@ -0,0 +1,123 @@
+/*
+* Justin W Li
+* keystroke.cpp
+* typing cost implementations
+*/
+
+#include "keystroke.h"
+#include <algorithm>    //std::min, std::max
+#include <string>       //std::string
+#include <thread>       //std::thread
+
+//where each key sits, and what it costs to reach
+struct key_info {
+	unsigned char hand;		//0 left, 1 right
+	unsigned char finger;	//0 to 7, left pinky to right pinky -- thumbs never type letters
+	unsigned char row;		//0 top, 1 home, 2 bottom
+	float cost;				//reach from home row plus rarity
+};
+
+//extra cost of striking b right after a
+static float pair_cost(const key_info& a, const key_info& b, bool same_key) {
+	if (a.hand != b.hand)
+		return 0.0f;						//hands alternating
+
+	float cost = 0.3f;						//one hand does both
+	if (a.finger == b.finger && !same_key)
+		cost += 1.0f;						//one finger has to move between keys
+	if (a.row + 2 == b.row || b.row + 2 == a.row)
+		cost += 0.5f;						//hand stretches over home row
+	return cost;
+}
+
+//every byte maps to its letter, or OTHER; a word's cost is then one table lookup per byte,
+//with no branches on which hand or finger is typing
+struct key_table {
+	static const unsigned char OTHER = 26;	//anything that is not a letter -- awkward reach, joins no pairs
+	static const unsigned char START = 27;	//before first letter of word
+
+	unsigned char keys[256];				//letter of each byte, case folded
+	float steps[28][28];					//cost of key, plus the pair it ends, by letter before and letter typed
+
+	key_table() {
+		//letters each finger strikes, left pinky to right pinky
+		static const char* const fingers[8] = { "qaz", "wsx", "edc", "rfvtgb", "yhnujm", "ik", "ol", "p" };
+		static const char* const rows[3] = { "qwertyuiop", "asdfghjkl", "zxcvbnm" };
+		static const float row_cost[3] = { 0.2f, 0.0f, 0.4f };
+		//english letter frequency, per mille, a to z -- e is most common
+		static const float freq[26] = { 82, 15, 28, 43, 127, 22, 20, 61, 70, 2, 8, 40, 24,
+			67, 75, 19, 1, 60, 63, 91, 28, 10, 24, 2, 20, 1 };
+		const float e_rarity = 20.0f / (freq['e' - 'a'] + 20.0f);
+
+		key_info info[26];
+		for (unsigned char f = 0; f < 8; ++f)
+		{
+			for (const char* p = fingers[f]; *p; ++p)
+			{
+				info[*p - 'a'].hand = f < 4 ? 0 : 1;
+				info[*p - 'a'].finger = f;
+			}
+		}
+		for (unsigned char r = 0; r < 3; ++r)
+		{
+			for (const char* p = rows[r]; *p; ++p)
+			{
+				//rarity is nothing for e, most of a key for q and z
+				info[*p - 'a'].row = r;
+				info[*p - 'a'].cost = 1.0f + row_cost[r] + 20.0f / (freq[*p - 'a'] + 20.0f) - e_rarity;
+			}
+		}
+
+		for (unsigned int c = 0; c < 256; ++c)
+			keys[c] = OTHER;
+		for (unsigned char l = 0; l < 26; ++l)
+			keys['a' + l] = keys['A' + l] = l;
+
+		for (unsigned char prev = 0; prev < 28; ++prev)
+		{
+			for (unsigned char l = 0; l < 26; ++l)
+				steps[prev][l] = info[l].cost + (prev < 26 ? pair_cost(info[prev], info[l], prev == l) : 0.0f);
+			steps[prev][OTHER] = 1.5f;
+		}
+	}
+};
+
+static const key_table table;
+
+float typing_cost(std::string_view word) {
+	float cost = 0.0f;
+	unsigned char prev = key_table::START;
+	for (char ch : word)
+	{
+		const unsigned char key = table.keys[static_cast<unsigned char>(ch)];
+		cost += table.steps[prev][key];
+		prev = key;
+	}
+	return cost;
+}
+
+std::vector<float> typing_costs(const word_store& store) {
+	const std::size_t n = store.size();
+	std::vector<float> costs(n);
+
+	//scoring is a few nanoseconds a word; only spread it out when there is enough to go around
+	const std::size_t per_thread = 1 << 16;
+	std::size_t threads = std::thread::hardware_concurrency();
+	threads = std::max<std::size_t>(1, std::min(threads, (n + per_thread - 1) / per_thread));
+
+	//each thread scores one run of indices, into its own part of costs
+	auto score = [&store, &costs](std::size_t first, std::size_t last) {
+		std::string buf(store.max_length(), '\0');
+		for (std::size_t i = first; i < last; ++i)
+			costs[i] = typing_cost(store.word(i, &buf[0]));
+	};
+
+	std::vector<std::thread> workers;
+	const std::size_t chunk = n / threads;
+	for (std::size_t t = 1; t < threads; ++t)
+		workers.emplace_back(score, t * chunk, t + 1 < threads ? (t + 1) * chunk : n);
+	score(0, threads > 1 ? chunk : n);
+	for (std::thread& w : workers)
+		w.join();
+	return costs;
+}
@@ -0,0 +1,24 @@
+/*
+* Justin W Li
+* keystroke.h
+* typing cost of words on a qwerty keyboard
+*/
+
+#ifndef KEYSTROKE_H
+#define KEYSTROKE_H
+
+#include "word_store.h"
+
+#include <string_view>	//std::string_view
+#include <vector>		//std::vector
+
+//effort of typing word with ten fingers on a qwerty keyboard -- higher is harder
+//every key costs its reach from home row plus how rarely it is typed; each pair of keys in a row
+//adds to that when both are on one hand, struck by one finger, or a row apart
+//ignores case; anything that is not a letter counts as an awkward reach
+float typing_cost(std::string_view word);
+
+//typing cost of every word in store, by index -- split between hardware threads
+std::vector<float> typing_costs(const word_store& store);
+
+#endif
@@ -0,0 +1,90 @@
+/*
+* Justin W Li
+* latency_histogram.cpp
+* log-bucketed latency histogram class implementations
+*/
+
+#include "latency_histogram.h"
+
+//highest set bit of a nonzero value
+static int highest_bit(std::uint64_t v) {
+#if defined(__GNUC__)
+	return 63 - __builtin_clzll(v);
+#else
+	int bit = 0;
+	while (v > 1)
+	{
+		v >>= 1;
+		++bit;
+	}
+	return bit;
+#endif
+}
+
+//ctor
+latency_histogram::latency_histogram() : counts(), total(0), longest(0) {
+	for (std::atomic<std::uint64_t>& c : counts)
+		c.store(0, std::memory_order_relaxed);
+}
+
+//durations below SUB get a bucket each; past that, a bucket holds the durations sharing their top SUB_BITS + 1 bits
+int latency_histogram::bucket(std::uint64_t ns) {
+	if (ns < SUB)
+		return static_cast<int>(ns);
+	const int high = highest_bit(ns);
+	if (high > TOP_BIT)
+		return BUCKETS - 1;
+	const int group = high - SUB_BITS + 1;
+	return group * SUB + static_cast<int>((ns >> (high - SUB_BITS)) & (SUB - 1));
+}
+
+std::uint64_t latency_histogram::lowest(int bucket) {
+	const int group = bucket / SUB;
+	const std::uint64_t sub = static_cast<std::uint64_t>(bucket % SUB);
+	return group == 0 ? sub : (SUB + sub) << (group - 1);
+}
+
+//only the recording thread writes, so a count is bumped with a load and a store rather than a locked add
+void latency_histogram::record(std::uint64_t ns) {
+	std::atomic<std::uint64_t>& c = counts[bucket(ns)];
+	c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (ns > longest.load(std::memory_order_relaxed))
+		longest.store(ns, std::memory_order_relaxed);
+}
+
+void latency_histogram::reset() {
+	for (std::atomic<std::uint64_t>& c : counts)
+		c.store(0, std::memory_order_relaxed);
+	total.store(0, std::memory_order_relaxed);
+	longest.store(0, std::memory_order_relaxed);
+}
+
+//read while recording goes on, counts may be a duration or two apart from total -- close enough for a percentile
+std::uint64_t latency_histogram::percentile(double p) const {
+	std::uint64_t recorded = 0;
+	for (const std::atomic<std::uint64_t>& c : counts)
+		recorded += c.load(std::memory_order_relaxed);
+	if (recorded == 0)
+		return 0;
+
+	//rank of the duration asked for, counting from 1
+	std::uint64_t rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(recorded) + 0.999999);
+	if (rank < 1)
+		rank = 1;
+	if (rank > recorded)
+		rank = recorded;
+
+	const std::uint64_t most = max();
+	std::uint64_t seen = 0;
+	for (int i = 0; i < BUCKETS; ++i)
+	{
+		seen += counts[i].load(std::memory_order_relaxed);
+		if (seen >= rank)
+		{
+			const std::uint64_t top = i + 1 < BUCKETS ? lowest(i + 1) - 1 : most;
+			return top < most ? top : most;
+		}
+	}
+	return most;
+}
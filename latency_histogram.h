@@ -0,0 +1,49 @@
+/*
+* Justin W Li
+* latency_histogram.h
+* log-bucketed latency histogram class definition
+*/
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>		//std::atomic
+#include <cstdint>		//std::uint64_t
+
+//-------------------------------
+//----LATENCY HISTOGRAM CLASS----
+//-------------------------------
+
+//counts durations in buckets that grow with them, as in an HDR histogram -- each power of two is split into 16
+//buckets, so any percentile read back is within about 6% of the duration it stands for, from a nanosecond up to
+//two minutes; longer ones all share the top bucket, though max keeps their exact size
+//one thread records, with plain loads and stores -- no locks, no allocation -- while any thread may read
+class latency_histogram {
+public:
+	static const int SUB_BITS = 4;
+	static const int SUB = 1 << SUB_BITS;							//buckets per power of two
+	static const int TOP_BIT = 36;									//highest bit of a duration bucketed apart
+	static const int BUCKETS = (TOP_BIT - SUB_BITS + 2) * SUB;
+
+private:
+	std::atomic<std::uint64_t> counts[BUCKETS];
+	std::atomic<std::uint64_t> total;								//durations recorded
+	std::atomic<std::uint64_t> longest;								//largest duration recorded
+
+	static int bucket(std::uint64_t ns);							//bucket duration falls in
+	static std::uint64_t lowest(int bucket);						//shortest duration falling in bucket
+
+public:
+	latency_histogram();
+	latency_histogram(const latency_histogram&) = delete;
+	latency_histogram& operator=(const latency_histogram&) = delete;
+
+	void record(std::uint64_t ns);									//only ever from one thread at a time
+	void reset();													//same
+	std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+	std::uint64_t max() const { return longest.load(std::memory_order_relaxed); }
+	std::uint64_t percentile(double p) const;						//duration p percent of those recorded are at most --
+																	//top of its bucket, or max if less; 0 if none are
+};
+
+#endif
@@ -2,13 +2,121 @@
 * Justin W Li
 * main.cpp
 * main function for game
+* usage: Goblins [seed] [--graded] [--strikes] [--dawg] [--typing] [--max-memory=MB] [--flat-events] [--coro-events]
+*	[--latency] [--quiet]
+*	seed -- replays that session's words and spawns; a session started without one prints its own
+*	--graded -- near misses do partial damage, or partly dodge
+*	--strikes -- an enemy strikes a few seconds after your word is shown, finished or not
+*	--dawg -- holds word bank as a word graph, if that takes less memory than the packed bank
+*	--typing -- tougher enemies get harder to type words, rather than longer ones
+*	--max-memory=MB -- refuses word lists that would compile larger than this
+*	--flat-events -- runs events on the flat engine (see event_engine.h)
+*	--coro-events -- runs each turn as a coroutine (see coro_engine.h) -- only if built as C++20
+*	--latency -- prints how long each type of event took, and waited on the player, once the game is over -- not
+*		with --flat-events or --coro-events
+*	--quiet -- prints nothing, for playing a prepared game piped into stdin
 */
 
 #include "game_loop.h"
-int main()
+#include <cstdio>	//std::fputs, std::fprintf
+#include <cstdlib>	//std::strtoull
+#include <cstring>	//std::strcmp, std::strncmp, std::strspn
+
+//engines a game can be played on
+enum engine_t { VIRTUAL, FLAT, CORO };
+
+static void play(game_loop& gl, engine_t engine) {
+	if (engine == FLAT)
+		gl.run_flat();
+#ifdef GOBLINS_COROUTINES
+	else if (engine == CORO)
+		gl.run_coro();
+#endif
+	else
+		gl.run();
+}
+
+int main(int argc, char* argv[])
 {
-	game_loop gl;
-	word_handler wh;
-	gl.run();
+	bool graded = false;
+	bool strikes = false;
+	engine_t engine = VIRTUAL;
+	bool quiet = false;
+	bool latency = false;
+	word_handler::backend storage = word_handler::PACKED;
+	word_handler::ranking order = word_handler::BY_LENGTH;
+	std::size_t memory_cap = 0;
+	const char* seed = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--graded") == 0)
+			graded = true;
+		else if (std::strcmp(argv[i], "--strikes") == 0)
+			strikes = true;
+		else if (std::strcmp(argv[i], "--dawg") == 0)
+			storage = word_handler::DAWG;
+		else if (std::strcmp(argv[i], "--typing") == 0)
+			order = word_handler::BY_TYPING;
+		else if (std::strcmp(argv[i], "--flat-events") == 0)
+			engine = FLAT;
+		else if (std::strcmp(argv[i], "--coro-events") == 0)
+		{
+#ifdef GOBLINS_COROUTINES
+			engine = CORO;
+#else
+			std::fputs("--coro-events needs the game built as C++20!\n", stderr);
+			return 1;
+#endif
+		}
+		else if (std::strcmp(argv[i], "--latency") == 0)
+			latency = true;
+		else if (std::strcmp(argv[i], "--quiet") == 0)
+			quiet = true;
+		else if (std::strncmp(argv[i], "--max-memory=", 13) == 0)
+			memory_cap = static_cast<std::size_t>(std::strtoull(argv[i] + 13, nullptr, 10)) << 20;
+		else if (argv[i][0] != '\0' && argv[i][std::strspn(argv[i], "0123456789")] == '\0')
+			seed = argv[i];
+		else
+		{
+			//a mistyped flag would otherwise be read as seed 0, and play a session nobody asked for
+			std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	//only event_handler keeps latency histograms -- the other engines would print nothing
+	if (latency && engine != VIRTUAL)
+	{
+		std::fputs("--latency only works without --flat-events and --coro-events!\n", stderr);
+		return 1;
+	}
+
+	//words.txt can be edited during a game, then picked up with kill -HUP
+	game_loop::reload_on_hangup();
+
+	null_io silent;
+	if (seed != nullptr)
+	{
+		game_loop gl(std::strtoull(seed, nullptr, 10), storage, order, memory_cap);
+		gl.set_graded(graded);
+		gl.set_strikes(strikes);
+		gl.set_latency_report(latency);
+		if (quiet)
+			gl.set_io(silent);
+		play(gl, engine);
+	}
+	else
+	{
+		game_loop gl(storage, order, memory_cap);
+		if (!quiet)	//seed is the only way back to a session started from the clock
+			std::fprintf(stderr, "Session seed: %llu -- pass it to Goblins to replay this session.\n",
+				static_cast<unsigned long long>(gl.get_seed()));
+		gl.set_graded(graded);
+		gl.set_strikes(strikes);
+		gl.set_latency_report(latency);
+		if (quiet)
+			gl.set_io(silent);
+		play(gl, engine);
+	}
 	return 0;
 }
\ No newline at end of file
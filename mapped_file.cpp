@@ -0,0 +1,122 @@
+/*
+* Justin W Li
+* mapped_file.cpp
+* read-only memory-mapped file class implementations
+*/
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>	//CreateFileA, CreateFileMappingA, MapViewOfFile
+#else
+#include <fcntl.h>		//open
+#include <sys/mman.h>	//mmap, munmap
+#include <sys/stat.h>	//fstat
+#include <unistd.h>		//close
+#endif
+
+//empty files cannot be mapped; point them here instead
+static const char empty_file[1] = { '\0' };
+
+#ifdef _WIN32
+mapped_file::mapped_file() : bytes(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {}
+#else
+mapped_file::mapped_file() : bytes(nullptr), length(0) {}
+#endif
+
+mapped_file::~mapped_file() { close(); }
+
+#ifdef _WIN32
+bool mapped_file::open(const char* path) {
+	close();
+
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		close();
+		return false;
+	}
+	length = static_cast<std::size_t>(file_size.QuadPart);
+	if (length == 0)
+	{
+		bytes = empty_file;
+		return true;
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (bytes == nullptr)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void mapped_file::close() {
+	if (bytes != nullptr && bytes != empty_file)
+		UnmapViewOfFile(bytes);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+
+	bytes = nullptr;
+	length = 0;
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+}
+#else
+bool mapped_file::open(const char* path) {
+	close();
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+	length = static_cast<std::size_t>(st.st_size);
+	if (length == 0)
+	{
+		::close(fd);
+		bytes = empty_file;
+		return true;
+	}
+
+	void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);	//mapping keeps its own reference to the file
+	if (addr == MAP_FAILED)
+	{
+		length = 0;
+		return false;
+	}
+	madvise(addr, length, MADV_SEQUENTIAL);	//bank is read front to back once
+
+	bytes = static_cast<const char*>(addr);
+	return true;
+}
+
+void mapped_file::close() {
+	if (bytes != nullptr && bytes != empty_file)
+		munmap(const_cast<char*>(bytes), length);
+	bytes = nullptr;
+	length = 0;
+}
+#endif
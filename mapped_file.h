@@ -0,0 +1,36 @@
+/*
+* Justin W Li
+* mapped_file.h
+* read-only memory-mapped file class definition
+*/
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>	//std::size_t
+
+//maps a whole file into memory, read-only; unmapped on destruction
+class mapped_file {
+	const char* bytes;						//start of mapping -- nullptr if nothing is mapped
+	std::size_t length;						//size of mapping in bytes
+
+#ifdef _WIN32
+	void* file;								//file handle
+	void* mapping;							//file mapping handle
+#endif
+
+public:
+	mapped_file();							//ctor -- maps nothing
+	~mapped_file();							//dtor -- unmaps file
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	bool open(const char* path);			//maps file at path; returns false if it could not be mapped
+	void close();							//unmaps file, if one is mapped
+
+	const char* data() const { return bytes; }
+	std::size_t size() const { return length; }
+	bool is_open() const { return bytes != nullptr; }
+};
+
+#endif
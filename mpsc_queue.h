@@ -0,0 +1,76 @@
+/*
+* Justin W Li
+* mpsc_queue.h
+* lock-free multi-producer, single-consumer queue class definition and function implementations
+*/
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>	//std::atomic, std::memory_order
+
+//--------------------------
+//----MPSC QUEUE CLASSES----
+//--------------------------
+
+//link every node of an mpsc_queue holds -- nodes derive from it, so queueing one never allocates
+struct mpsc_node {
+	std::atomic<mpsc_node*> next_posted;
+	mpsc_node() : next_posted(nullptr) {}
+};
+
+//dmitry vyukov's intrusive queue -- any thread can push, without locks or retries; only one thread pops
+//a push swaps itself in as the back of the queue, then links the old back to itself; until that second step,
+//the consumer sees the queue end before it, so pop can come back empty while a push is halfway done
+class mpsc_queue {
+	alignas(64) std::atomic<mpsc_node*> back;		//node pushed last -- shared by every producer
+	alignas(64) mpsc_node* front;					//node to pop next -- consumer's alone
+	mpsc_node stub;									//stands in as a node whenever the queue runs dry
+
+public:
+	mpsc_queue() : back(&stub), front(&stub), stub() {}
+	mpsc_queue(const mpsc_queue&) = delete;
+	mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+	//adds node to back -- safe from any thread
+	void push(mpsc_node* n) {
+		n->next_posted.store(nullptr, std::memory_order_relaxed);
+		mpsc_node* prev = back.exchange(n, std::memory_order_acq_rel);
+		prev->next_posted.store(n, std::memory_order_release);
+	}
+
+	//takes node from front; nullptr if queue is empty, or its next node is still being pushed -- consumer only
+	mpsc_node* pop() {
+		mpsc_node* first = front;
+		mpsc_node* next = first->next_posted.load(std::memory_order_acquire);
+		if (first == &stub)
+		{
+			if (next == nullptr)
+				return nullptr;
+			front = first = next;
+			next = next->next_posted.load(std::memory_order_acquire);
+		}
+		if (next != nullptr)
+		{
+			front = next;
+			return first;
+		}
+
+		//first is the last node linked -- it can only be taken once something is behind it, so put stub there
+		if (first != back.load(std::memory_order_acquire))
+			return nullptr;
+		push(&stub);
+		next = first->next_posted.load(std::memory_order_acquire);
+		if (next == nullptr)
+			return nullptr;
+		front = next;
+		return first;
+	}
+
+	//returns whether nothing has been pushed that is not popped yet, halfway pushes included -- consumer only
+	bool empty() const {
+		return front == &stub && back.load(std::memory_order_acquire) == &stub;
+	}
+};
+
+#endif
@@ -40,7 +40,7 @@ public:
 	bool alive() const { return hp > 0; }
 	void fully_heal() { hp = (static_cast<int>(level) - 1) * 25 + 50; }	//fully heal player
 	void game_over() { hp = 0; }						//sets hp to zero -- only called in player_quit
-	void print_stats() { std::cout << "HP: " << hp << ", ATT: " 
+	void print_stats(std::ostream& out) { out << "HP: " << hp << ", ATT: " 
 		<< atk << ", EXP: " << exp << ", LVL: " << level << std::endl; }
 };
 
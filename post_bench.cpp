@@ -0,0 +1,163 @@
+/*
+* Justin W Li
+* post_bench.cpp
+* posts events to one event_handler from many threads at once, checks every one ran once and in order, and times it
+* usage: post_bench [producers] [events] [rounds]
+*	producers -- threads posting events (default 8)
+*	events -- events each producer posts (default 200000)
+*	rounds -- runs timed on each intake; the fastest is reported (default 3)
+* exits with 1 if any event was lost, run twice, or run out of the order its producer posted it in
+*/
+
+#include "event_handler.h"
+#include "room_handler.h"
+
+#include <atomic>		//std::atomic
+#include <chrono>		//std::chrono::steady_clock
+#include <cstdint>		//std::uint64_t
+#include <cstdio>		//std::printf, std::fputs
+#include <cstdlib>		//std::strtoul
+#include <mutex>		//std::mutex, std::lock_guard
+#include <thread>		//std::thread, std::this_thread::yield
+#include <utility>		//std::swap
+#include <vector>		//std::vector
+
+//what the consumer has seen of each producer's events
+struct tally {
+	std::vector<std::uint64_t> next;				//seq each producer's next event should have
+	std::uint64_t ran = 0;
+	bool out_of_order = false;
+};
+
+//event carrying which producer posted it, and how many it had posted before
+class tick : public game_event {
+	tally* t;
+	unsigned int producer;
+	std::uint64_t seq;
+
+	void run_event() {
+		if (t->next[producer] != seq)
+			t->out_of_order = true;
+		t->next[producer] = seq + 1;
+		++t->ran;
+		complete_event();
+	}
+
+public:
+	tick(event_handler* evh_, room_handler* rh_, tally* t_, unsigned int producer_, std::uint64_t seq_) :
+		game_event(evh_, rh_, FEEDBACK), t(t_), producer(producer_), seq(seq_) {}
+};
+
+//what post_event replaces -- producers take turns at a mutex, and the consumer swaps out everything they added
+class locked_intake {
+	std::mutex lock;
+	std::vector<game_event*> events;
+	std::vector<game_event*> taken;
+
+public:
+	void post(game_event* e) {
+		std::lock_guard<std::mutex> hold(lock);
+		events.push_back(e);
+	}
+	void drain(event_handler& evh) {
+		{
+			std::lock_guard<std::mutex> hold(lock);
+			std::swap(events, taken);
+		}
+		for (game_event* e : taken)
+			evh.add_event(e);
+		taken.clear();
+	}
+};
+
+//posts every producer's events through one intake while this thread runs them; returns seconds it took
+static double play(bool locked, unsigned int producers, std::uint64_t events, bool& ok) {
+	event_handler evh;
+	room_handler rh;
+	locked_intake intake;
+	tally t;
+	t.next.assign(producers, 0);
+
+	std::atomic<unsigned int> ready(0);
+	std::atomic<bool> go(false);
+	std::vector<std::thread> threads;
+	for (unsigned int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&, p]() {
+			++ready;
+			while (!go)
+				std::this_thread::yield();
+			for (std::uint64_t i = 0; i < events; ++i)
+			{
+				game_event* e = new tick(&evh, &rh, &t, p, i);
+				if (locked)
+					intake.post(e);
+				else
+					evh.post_event(e);
+			}
+		});
+	}
+	while (ready != producers)
+		std::this_thread::yield();
+
+	const std::uint64_t total = producers * events;
+	std::chrono::steady_clock::time_point start_t = std::chrono::steady_clock::now();
+	go = true;
+	while (t.ran < total)
+	{
+		const std::uint64_t before = t.ran;
+		if (locked)
+			intake.drain(evh);
+		evh.run_events();
+		if (t.ran == before)
+			std::this_thread::yield();		//producers may share this core
+	}
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_t).count();
+
+	for (std::thread& th : threads)
+		th.join();
+	for (unsigned int p = 0; p < producers; ++p)
+		if (t.next[p] != events)
+			ok = false;
+	if (t.out_of_order || t.ran != total)
+		ok = false;
+	return secs;
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned int producers = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 8;
+	const std::uint64_t events = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+	const unsigned long rounds = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 3;
+
+	try {
+		const char* names[2] = { "lock-free (post_event)", "mutex" };
+		double best[2] = { 0, 0 };
+		bool ok = true;
+		for (unsigned long r = 0; r < rounds; ++r)
+		{
+			//take turns, so neither intake always runs on a warmer machine
+			for (int locked = 0; locked < 2; ++locked)
+			{
+				double secs = play(locked == 1, producers, events, ok);
+				if (r == 0 || secs < best[locked])
+					best[locked] = secs;
+			}
+		}
+
+		const double total = static_cast<double>(producers) * events;
+		for (int locked = 0; locked < 2; ++locked)
+			std::printf("%-24s %u producers  %8.2f ms  %10.0f events/s\n", names[locked], producers,
+				best[locked] * 1000, total / best[locked]);
+		if (!ok)
+		{
+			std::printf("events were lost, repeated or reordered!\n");
+			return 1;
+		}
+	}
+	catch (const char* e) {
+		std::fputs(e, stderr);
+		return 1;
+	}
+	return 0;
+}
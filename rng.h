@@ -0,0 +1,129 @@
+/*
+* Justin W Li
+* rng.h
+* random number generator class definition and function implementations
+*/
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>	//std::uint64_t
+
+#ifdef _MSC_VER
+#include <intrin.h>	//_umul128
+#endif
+
+//-----------------
+//----RNG CLASS----
+//-----------------
+
+//xoshiro256** generator -- one per game session, never shared between threads
+//a session seeded with the same value replays the same words and spawns
+class rng {
+	std::uint64_t s[4];						//generator state
+
+	static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+	//high, low halves of a 128-bit product
+	static std::uint64_t mul_hi(std::uint64_t a, std::uint64_t b, std::uint64_t& lo) {
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+		lo = static_cast<std::uint64_t>(p);
+		return static_cast<std::uint64_t>(p >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		std::uint64_t hi;
+		lo = _umul128(a, b, &hi);
+		return hi;
+#else
+		std::uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+		std::uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+		std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+		std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFu) + (hl & 0xFFFFFFFFu);
+		lo = (mid << 32) | (ll & 0xFFFFFFFFu);
+		return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+	}
+
+public:
+	explicit rng(std::uint64_t seed_ = 0) { seed(seed_); }
+
+	//expands seed into full state with splitmix64, so nearby seeds give unrelated streams
+	void seed(std::uint64_t seed_) {
+		for (int i = 0; i < 4; ++i)
+		{
+			std::uint64_t z = (seed_ += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			s[i] = z ^ (z >> 31);
+		}
+	}
+
+	//next 64 random bits
+	std::uint64_t next() {
+		const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+		const std::uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	//unbiased random number in [0, n) -- lemire's multiply-shift, rejecting the rare biased draws
+	std::uint64_t bounded(std::uint64_t n) {
+		std::uint64_t lo;
+		std::uint64_t hi = mul_hi(next(), n, lo);
+		if (lo < n)
+		{
+			const std::uint64_t threshold = (0 - n) % n;
+			while (lo < threshold)
+				hi = mul_hi(next(), n, lo);
+		}
+		return hi;
+	}
+
+	//raw state -- restoring it resumes the stream exactly where it was saved
+	void get_state(std::uint64_t out[4]) const {
+		for (int i = 0; i < 4; ++i)
+			out[i] = s[i];
+	}
+	void set_state(const std::uint64_t in[4]) {
+		for (int i = 0; i < 4; ++i)
+			s[i] = in[i];
+	}
+
+	//advances 2^128 draws -- streams split off this way never overlap
+	void jump() {
+		static const std::uint64_t JUMP[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+			0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+
+		std::uint64_t t[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int b = 0; b < 64; ++b)
+			{
+				if (JUMP[i] & (std::uint64_t(1) << b))
+				{
+					t[0] ^= s[0];
+					t[1] ^= s[1];
+					t[2] ^= s[2];
+					t[3] ^= s[3];
+				}
+				next();
+			}
+		}
+		for (int i = 0; i < 4; ++i)
+			s[i] = t[i];
+	}
+
+	//returns independent stream for another thread or session; this one jumps past it
+	rng split() {
+		rng child(*this);
+		jump();
+		return child;
+	}
+};
+
+#endif
@@ -5,22 +5,38 @@
 */
 
 #include "room_handler.h"
+#include <iterator>	//std::prev
 
 //room struct ctor
 room_handler::room::room(unsigned int limit_) : turns(0), limit(limit_), spawned(0), killed(0), died(0), attacked(0), dodged(0) {}
 
 //room handler ctor
-room_handler::room_handler() : rooms(), performance(0), next_limit(0), room_number(0), max_rooms(3) {
+room_handler::room_handler() : rooms(), spare(), performance(0), next_limit(0), room_number(0), max_rooms(3) {
 	next(); //make one room to start off
 }
 
+//same state as a new room handler, but every room is kept as a spare
+void room_handler::restart() {
+	spare.splice(spare.begin(), rooms);
+	performance = 0;
+	next_limit = 0;
+	room_number = 0;
+	next();
+}
+
 //proceed to next room
 void room_handler::next(unsigned int limit) {
 	//do not have more than the maximum number of rooms
-	if (rooms.size() == max_rooms) rooms.pop_back();
+	if (rooms.size() == max_rooms) spare.splice(spare.begin(), rooms, std::prev(rooms.end()));
 
-	//add new, blank room to front of list
-	rooms.push_front(room(limit));
+	//add new, blank room to front of list, in a spare room's node if there is one
+	if (spare.empty())
+		rooms.push_front(room(limit));
+	else
+	{
+		rooms.splice(rooms.begin(), spare, spare.begin());
+		rooms.front() = room(limit);
+	}
 	++room_number;
 }
 
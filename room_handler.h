@@ -32,6 +32,7 @@ class room_handler
 	};
 
 	std::list<room> rooms;					//list storing room
+	std::list<room> spare;					//rooms dropped off the back, kept so the next room needs no allocation
 
 	int performance;						//current player performance score
 	unsigned int next_limit;				//maximum number of enemies to be spaned in next room
@@ -45,11 +46,13 @@ class room_handler
 public:
 
 	room_handler();
+	void restart();							//back to the first room, as a new room_handler -- keeps its rooms' storage
 
 	bool can_spawn() const;					//returns whether more enemies can be spawned
 	void room_over();						//to be called when room is complete
 	void reset();							//resets room's spawns
 	int get_performance();			//returns performance score
+	int get_room() const { return room_number; }	//returns number of current room, counting from 1
 
 	//metrics callback functions
 	void turnOver();						//notifies room that turn is over
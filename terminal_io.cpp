@@ -0,0 +1,196 @@
+/*
+* Justin W Li
+* terminal_io.cpp
+* raw-mode terminal input/output function implementations
+*/
+
+#ifndef _WIN32
+
+#include "terminal_io.h"
+#include <cerrno>		//errno, EINTR
+#include <csignal>		//std::raise, SIGINT
+#include <iostream>		//std::cout
+#include <poll.h>		//poll
+#include <termios.h>	//tcgetattr, tcsetattr, tcflush
+#include <unistd.h>		//read, close, isatty
+
+#ifdef __linux__
+#include <sys/timerfd.h>	//timerfd_create, timerfd_settime
+#endif
+
+//puts the terminal in raw mode for as long as it lives; drain throws away keys typed before then
+//signal keys are read as keys too, so raw mode is always undone before acting on one
+class raw_mode {
+	termios saved;
+	bool set;
+
+public:
+	explicit raw_mode(bool drain) : saved(), set(false) {
+		if (tcgetattr(STDIN_FILENO, &saved) != 0)
+			return;
+		termios raw = saved;
+		raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+		raw.c_cc[VMIN] = 1;
+		raw.c_cc[VTIME] = 0;
+		set = tcsetattr(STDIN_FILENO, drain ? TCSAFLUSH : TCSANOW, &raw) == 0;
+	}
+	~raw_mode() { restore(); }
+
+	void restore() {
+		if (set)
+			tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+		set = false;
+	}
+};
+
+//-----------------------------------
+//----TERMINAL IO IMPLEMENTATIONS----
+//-----------------------------------
+
+terminal_io::terminal_io() : game_io(&std::cout), timer(-1), line_taken(false), closed(false) {
+#ifdef __linux__
+	timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);	//steady_clock counts on CLOCK_MONOTONIC
+#endif
+}
+
+terminal_io::~terminal_io() {
+	if (timer != -1)
+		close(timer);
+}
+
+bool terminal_io::available() { return isatty(STDIN_FILENO) == 1; }
+
+//reads keys until enter, the deadline, or the end of input; echoes them, and lets backspace undo them
+terminal_io::ending terminal_io::read_line(std::string& typed, const std::chrono::steady_clock::time_point* deadline,
+	bool drain) {
+	typed.clear();
+	if (closed)
+		return CLOSED;
+	text->flush();
+
+	raw_mode raw(drain);
+
+	//watch the timer, or failing that, time out the poll itself
+	pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { timer, POLLIN, 0 } };
+	nfds_t watched = 1;
+#ifdef __linux__
+	if (deadline != nullptr && timer != -1)
+	{
+		const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline->time_since_epoch()).count();
+		itimerspec when = {};
+		when.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+		when.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+		if (when.it_value.tv_sec == 0 && when.it_value.tv_nsec == 0)
+			when.it_value.tv_nsec = 1;							//0 would disarm timer
+		if (timerfd_settime(timer, TFD_TIMER_ABSTIME, &when, nullptr) == 0)
+			watched = 2;
+	}
+#endif
+
+	ending end = CLOSED;
+	for (bool reading = true; reading;)
+	{
+		int wait_ms = -1;
+		if (deadline != nullptr && watched == 1)
+		{
+			const long long left = std::chrono::duration_cast<std::chrono::milliseconds>(
+				*deadline - std::chrono::steady_clock::now()).count();
+			wait_ms = left > 0 ? static_cast<int>(left) + 1 : 0;
+		}
+
+		const int ready = poll(fds, watched, wait_ms);
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (ready == 0 || (watched == 2 && (fds[1].revents & POLLIN)))
+		{
+			end = LATE;
+			break;
+		}
+		if ((fds[0].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+			continue;
+
+		char keys[64];
+		const ssize_t got = read(STDIN_FILENO, keys, sizeof(keys));
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			break;
+
+		//keys after enter are typed ahead of the next prompt -- dropped along with the rest when it comes
+		for (ssize_t i = 0; i < got && reading; ++i)
+		{
+			const char c = keys[i];
+			if (c == '\r' || c == '\n')
+			{
+				end = ENTER;
+				reading = false;
+			}
+			else if (c == 0x7F || c == '\b')
+			{
+				if (!typed.empty())
+				{
+					typed.pop_back();
+					*text << "\b \b";
+				}
+			}
+			else if (c == 0x03)					//ctrl-c
+			{
+				raw.restore();
+				*text << std::endl;
+				std::raise(SIGINT);
+			}
+			else if (c == 0x04 && typed.empty())	//ctrl-d
+				reading = false;
+			else if (c >= 0x20 && c < 0x7F)
+			{
+				typed.push_back(c);
+				*text << c;
+			}
+		}
+		text->flush();
+	}
+
+#ifdef __linux__
+	if (watched == 2)
+	{
+		const itimerspec off = {};
+		timerfd_settime(timer, 0, &off, nullptr);		//disarm, and clear any expiry not read
+	}
+#endif
+
+	if (end == CLOSED)
+		closed = true;
+	*text << std::endl;
+	return end;
+}
+
+//word is cut off where it stood once deadline passes -- combat sees the time and counts it a miss
+//the player never pressed enter then, so the next wait_enter still waits for it
+void terminal_io::read_word(std::string& typed, std::string_view, std::chrono::steady_clock::time_point deadline) {
+	line_taken = read_line(typed, &deadline, true) == ENTER;
+}
+
+void terminal_io::read_choice(std::string& typed, std::string_view, std::string_view fail) {
+	const ending end = read_line(typed, nullptr, true);
+	if (end == CLOSED)
+		typed.assign(fail.data(), fail.size());
+	line_taken = end == ENTER;
+}
+
+//right after a read, its line is already over; otherwise waits for enter -- one typed early counts, as
+//a player pressing it just as the prompt shows should not have it lost
+void terminal_io::wait_enter() {
+	if (line_taken)
+	{
+		line_taken = false;
+		return;
+	}
+	std::string ignored;
+	read_line(ignored, nullptr, false);
+}
+
+#endif
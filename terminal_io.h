@@ -0,0 +1,50 @@
+/*
+* Justin W Li
+* terminal_io.h
+* raw-mode terminal input/output class definition
+*/
+
+#ifndef TERMINAL_IO_H
+#define TERMINAL_IO_H
+
+#ifndef _WIN32
+
+#include "game_io.h"
+
+#include <chrono>		//std::chrono::steady_clock
+#include <string>		//std::string
+#include <string_view>	//std::string_view
+
+//-------------------------
+//----TERMINAL IO CLASS----
+//-------------------------
+
+//reads the terminal a key at a time, so a word can be cut off the moment its time is up
+//the terminal is only in raw mode while a line is being read, and keys typed before a word or choice is asked
+//for are thrown away, so keys pressed early never count towards it
+//prints to std::cout
+class terminal_io : public game_io {
+	int timer;											//timer firing at a word's deadline -- -1 if there is none
+	bool line_taken;									//whether last read already took the enter ending it
+	bool closed;										//whether input has ended
+
+	enum ending { ENTER, LATE, CLOSED };
+	ending read_line(std::string& typed, const std::chrono::steady_clock::time_point* deadline,
+		bool drain);									//deadline of nullptr waits forever; drain drops keys typed early
+
+public:
+	terminal_io();
+	~terminal_io();
+	terminal_io(const terminal_io&) = delete;
+	terminal_io& operator=(const terminal_io&) = delete;
+
+	static bool available();							//returns whether stdin is a terminal
+
+	void read_word(std::string& typed, std::string_view target, std::chrono::steady_clock::time_point deadline);
+	void read_choice(std::string& typed, std::string_view pass, std::string_view fail);	//fail once input ends
+	void wait_enter();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+/*
+* Justin W Li
+* timing_wheel.cpp
+* hierarchical timing wheel function implementations
+*/
+
+#include "timing_wheel.h"
+
+//lowest set bit of a nonzero mask
+static int lowest_bit(std::uint64_t mask) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(mask);
+#else
+	int bit = 0;
+	while ((mask & 1) == 0)
+	{
+		mask >>= 1;
+		++bit;
+	}
+	return bit;
+#endif
+}
+
+//rotates mask right, so bit k moves to bit 0
+static std::uint64_t rotr(std::uint64_t mask, int k) { return k == 0 ? mask : (mask >> k) | (mask << (64 - k)); }
+
+//ctor -- every list starts out empty, pointing at its own head
+timing_wheel::timing_wheel() : lists(), occupied(), now(0), count(0) {
+	for (wheel_node& head : lists)
+		head.prev = head.next = &head;
+}
+
+void timing_wheel::link(wheel_node* n, std::uint16_t slot) {
+	wheel_node& head = lists[slot];
+	n->prev = head.prev;
+	n->next = &head;
+	head.prev->next = n;
+	head.prev = n;
+	n->slot = slot;
+	if (slot != EXPIRED)
+		occupied[slot >> SLOT_BITS] |= std::uint64_t(1) << (slot & (SLOTS - 1));
+}
+
+void timing_wheel::unlink(wheel_node* n) {
+	n->prev->next = n->next;
+	n->next->prev = n->prev;
+	const std::uint16_t slot = n->slot;
+	if (slot != EXPIRED && lists[slot].next == &lists[slot])
+		occupied[slot >> SLOT_BITS] &= ~(std::uint64_t(1) << (slot & (SLOTS - 1)));
+	n->prev = n->next = nullptr;
+	n->slot = NONE;
+}
+
+//lowest wheel whose reach covers the wait -- past the top wheel's reach, the node waits in its farthest slot,
+//and is placed again when that slot comes round
+void timing_wheel::place(wheel_node* n) {
+	if (n->due <= now)
+	{
+		link(n, EXPIRED);
+		return;
+	}
+	const std::uint64_t wait = n->due - now;
+	for (int level = 0; level < LEVELS; ++level)
+	{
+		const int shift = SLOT_BITS * (level + 1);
+		if (wait < (std::uint64_t(1) << shift))
+		{
+			const std::uint64_t index = (n->due >> (SLOT_BITS * level)) & (SLOTS - 1);
+			link(n, static_cast<std::uint16_t>(level * SLOTS + index));
+			return;
+		}
+	}
+	const int top = LEVELS - 1;
+	const std::uint64_t index = ((now >> (SLOT_BITS * top)) + SLOTS - 1) & (SLOTS - 1);
+	link(n, static_cast<std::uint16_t>(top * SLOTS + index));
+}
+
+//nodes in a slot that has come round are due within it, so each lands in a lower wheel, or expires
+void timing_wheel::cascade(int level) {
+	const std::uint16_t slot = static_cast<std::uint16_t>(level * SLOTS + ((now >> (SLOT_BITS * level)) & (SLOTS - 1)));
+	wheel_node& head = lists[slot];
+	while (head.next != &head)
+	{
+		wheel_node* n = head.next;
+		unlink(n);
+		place(n);
+	}
+}
+
+//slots are looked at from the one after the current onwards; the current one, already cascaded or expired,
+//holds only nodes a whole turn of the wheel away, so it comes last
+std::uint64_t timing_wheel::next_slot(int level) const {
+	if (occupied[level] == 0)
+		return NEVER;
+	const int shift = SLOT_BITS * level;
+	const int index = static_cast<int>((now >> shift) & (SLOTS - 1));
+	const int ahead = lowest_bit(rotr(occupied[level], (index + 1) & (SLOTS - 1))) + 1;
+	return ((now >> shift) + ahead) << shift;
+}
+
+void timing_wheel::insert(wheel_node* n, std::uint64_t due) {
+	n->due = due;
+	place(n);
+	++count;
+}
+
+void timing_wheel::cancel(wheel_node* n) {
+	if (n->slot == NONE)
+		return;
+	unlink(n);
+	--count;
+}
+
+//jumps from one tick something happens at to the next -- a slot coming round, or a node coming due
+void timing_wheel::advance(std::uint64_t to) {
+	while (now < to)
+	{
+		const std::uint64_t wake = next_tick();
+		if (wake > to)
+		{
+			now = to;		//nothing in between
+			return;
+		}
+		now = wake;
+		for (int level = LEVELS - 1; level > 0; --level)
+			if ((now & ((std::uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0)
+				cascade(level);
+
+		//lowest wheel's slot is this very tick -- all of it is due
+		const std::uint16_t slot = static_cast<std::uint16_t>(now & (SLOTS - 1));
+		wheel_node& head = lists[slot];
+		while (head.next != &head)
+		{
+			wheel_node* n = head.next;
+			unlink(n);
+			link(n, EXPIRED);
+		}
+	}
+}
+
+wheel_node* timing_wheel::pop_expired() {
+	wheel_node& head = lists[EXPIRED];
+	if (head.next == &head)
+		return nullptr;
+	wheel_node* n = head.next;
+	unlink(n);
+	--count;
+	return n;
+}
+
+std::uint64_t timing_wheel::next_tick() const {
+	std::uint64_t wake = NEVER;
+	for (int level = 0; level < LEVELS; ++level)
+	{
+		const std::uint64_t t = next_slot(level);
+		if (t < wake)
+			wake = t;
+	}
+	return wake;
+}
+
+//expired nodes are waiting to be taken now
+std::uint64_t timing_wheel::next_wake() const {
+	return lists[EXPIRED].next != &lists[EXPIRED] ? now : next_tick();
+}
@@ -0,0 +1,67 @@
+/*
+* Justin W Li
+* timing_wheel.h
+* hierarchical timing wheel class definition
+*/
+
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <cstdint>	//std::uint16_t, std::uint32_t, std::uint64_t
+
+//--------------------------
+//----TIMING WHEEL CLASS----
+//--------------------------
+
+//link every node of a timing_wheel holds -- nodes derive from it, so scheduling one never allocates
+struct wheel_node {
+	wheel_node* prev;
+	wheel_node* next;
+	std::uint64_t due;						//tick node expires at
+	std::uint16_t slot;						//list node is in -- level * SLOTS + index, EXPIRED, or NONE
+	std::uint32_t tag;						//free for whoever schedules node
+
+	wheel_node() : prev(nullptr), next(nullptr), due(0), slot(0xFFFF), tag(0) {}
+};
+
+//nodes waiting for a tick, kept in four wheels of 64 slots -- each slot of a wheel spans all 64 of the wheel below
+//a node goes in the lowest wheel that reaches its tick; whenever a wheel comes round to a slot, the nodes in it
+//move down a wheel, until they reach the lowest, whose slots are single ticks
+//scheduling and cancelling are O(1); ticks with nothing due are skipped over, rather than stepped through
+class timing_wheel {
+public:
+	static const int LEVELS = 4;
+	static const int SLOT_BITS = 6;
+	static const int SLOTS = 1 << SLOT_BITS;
+	static const std::uint16_t EXPIRED = LEVELS * SLOTS;	//slot of nodes due, waiting to be taken
+	static const std::uint16_t NONE = 0xFFFF;				//slot of nodes not in the wheel
+	static const std::uint64_t NEVER = ~std::uint64_t(0);
+
+private:
+	wheel_node lists[LEVELS * SLOTS + 1];	//circular list of each slot, headed by a node of its own; then expired nodes
+	std::uint64_t occupied[LEVELS];			//bit per slot of each wheel whose list is not empty
+	std::uint64_t now;						//tick wheel has been advanced to
+	std::uint64_t count;					//nodes in wheel, expired ones included
+
+	void link(wheel_node* n, std::uint16_t slot);	//adds node to back of slot's list
+	void unlink(wheel_node* n);				//takes node out of its list
+	void place(wheel_node* n);				//links node into slot its due tick falls in
+	void cascade(int level);				//moves nodes in level's current slot down
+	std::uint64_t next_slot(int level) const;	//first tick level's next nonempty slot starts at; NEVER if it has none
+	std::uint64_t next_tick() const;		//first tick any wheel's next nonempty slot starts at; NEVER if there is none
+
+public:
+	timing_wheel();
+	timing_wheel(const timing_wheel&) = delete;
+	timing_wheel& operator=(const timing_wheel&) = delete;
+
+	void insert(wheel_node* n, std::uint64_t due);	//schedules node -- one due by now is expired at once
+	void cancel(wheel_node* n);				//takes node out of wheel, expired or not
+	void advance(std::uint64_t to);			//expires every node due by tick to, in the order they are due
+	wheel_node* pop_expired();				//oldest expired node; nullptr if there are none
+	std::uint64_t next_wake() const;		//tick advance must next be called by -- nodes are due no sooner; NEVER if empty
+	std::uint64_t current() const { return now; }
+	bool empty() const { return count == 0; }
+};
+
+#endif
@@ -0,0 +1,223 @@
+/*
+* Justin W Li
+* trace.cpp
+* trace recorder class implementations
+*/
+
+#include "trace.h"
+
+#ifdef GOBLINS_TRACE
+
+#include <chrono>		//std::chrono::steady_clock
+#include <csignal>		//std::signal
+#include <cstdlib>		//std::atexit, std::getenv
+#include <cstring>		//std::strlen, std::strcpy
+
+#ifdef _WIN32
+#include <fcntl.h>		//_O_WRONLY, _O_CREAT, _O_TRUNC
+#include <io.h>			//_open, _write, _close
+#include <sys/stat.h>	//_S_IREAD, _S_IWRITE
+#else
+#include <fcntl.h>		//open
+#include <unistd.h>		//write, close
+#endif
+
+std::atomic<tracer::ring*> tracer::rings[tracer::MAX_THREADS];
+std::atomic<unsigned int> tracer::threads(0);
+
+//---------------------------------
+//----RECORDING IMPLEMENTATIONS----
+//---------------------------------
+
+std::uint64_t tracer::now() {
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//rings are never freed -- a thread that has ended still has its spans dumped
+tracer::ring* tracer::local() {
+	thread_local ring* mine = []() -> ring* {
+		const unsigned int index = threads.fetch_add(1, std::memory_order_relaxed);
+		if (index >= MAX_THREADS)
+			return nullptr;
+		ring* r = new ring();
+		r->written.store(0, std::memory_order_relaxed);
+		r->tid = index + 1;
+		rings[index].store(r, std::memory_order_release);
+		return r;
+	}();
+	return mine;
+}
+
+//only the owning thread writes a ring, so a span is a store and a counter bump
+void tracer::add(const record& r) {
+	ring* mine = local();
+	if (mine == nullptr)
+		return;
+	const std::uint64_t n = mine->written.load(std::memory_order_relaxed);
+	mine->records[n & (RING_SIZE - 1)] = r;
+	mine->written.store(n + 1, std::memory_order_release);
+}
+
+//----------------------------
+//----DUMP IMPLEMENTATIONS----
+//----------------------------
+
+//JSON built up a buffer at a time, written with plain write calls -- no locks, allocation or stdio, so it can
+//run in a signal handler
+class trace_writer {
+	int fd;
+	char buf[4096];
+	std::size_t used;
+
+public:
+	explicit trace_writer(int fd_) : fd(fd_), used(0) {}
+	~trace_writer() { flush(); }
+
+	void flush() {
+		const char* p = buf;
+		while (used > 0)
+		{
+#ifdef _WIN32
+			const int n = _write(fd, p, static_cast<unsigned int>(used));
+#else
+			const long n = static_cast<long>(::write(fd, p, used));
+#endif
+			if (n <= 0)
+				break;
+			p += n;
+			used -= static_cast<std::size_t>(n);
+		}
+		used = 0;
+	}
+	void put(const char* s) {
+		for (; *s != '\0'; ++s)
+		{
+			if (used == sizeof(buf))
+				flush();
+			buf[used++] = *s;
+		}
+	}
+	void put(std::uint64_t v) {
+		char digits[21];
+		int n = 0;
+		do {
+			digits[n++] = static_cast<char>('0' + v % 10);
+			v /= 10;
+		} while (v != 0);
+		char s[21];
+		for (int i = 0; i < n; ++i)
+			s[i] = digits[n - 1 - i];
+		s[n] = '\0';
+		put(s);
+	}
+	void put_us(std::uint64_t ns) {						//nanoseconds, as microseconds to three places
+		put(ns / 1000);
+		char frac[5] = { '.', static_cast<char>('0' + ns / 100 % 10), static_cast<char>('0' + ns / 10 % 10),
+			static_cast<char>('0' + ns % 10), '\0' };
+		put(frac);
+	}
+};
+
+//spans are written oldest first per thread; a thread still tracing may write over a span as it is read
+bool tracer::dump(const char* path) {
+#ifdef _WIN32
+	const int fd = _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+	const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+	if (fd < 0)
+		return false;
+
+	unsigned int count = threads.load(std::memory_order_acquire);
+	if (count > MAX_THREADS)
+		count = MAX_THREADS;
+
+	//timestamps start at the earliest span kept
+	std::uint64_t origin = ~std::uint64_t(0);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const ring* r = rings[i].load(std::memory_order_acquire);
+		if (r == nullptr)
+			continue;
+		const std::uint64_t written = r->written.load(std::memory_order_acquire);
+		for (std::uint64_t n = written > RING_SIZE ? written - RING_SIZE : 0; n < written; ++n)
+			if (r->records[n & (RING_SIZE - 1)].begin < origin)
+				origin = r->records[n & (RING_SIZE - 1)].begin;
+	}
+
+	{
+		trace_writer out(fd);
+		out.put("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+		bool first = true;
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const ring* r = rings[i].load(std::memory_order_acquire);
+			if (r == nullptr)
+				continue;
+			const std::uint64_t written = r->written.load(std::memory_order_acquire);
+			for (std::uint64_t n = written > RING_SIZE ? written - RING_SIZE : 0; n < written; ++n)
+			{
+				const record rec = r->records[n & (RING_SIZE - 1)];
+				if (rec.begin < origin || rec.end < rec.begin)
+					continue;								//written over while being read
+				out.put(first ? "\n" : ",\n");
+				first = false;
+				out.put("{\"name\":\"");
+				out.put(rec.name);
+				out.put("\",\"cat\":\"");
+				out.put(rec.cat);
+				out.put("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+				out.put(static_cast<std::uint64_t>(r->tid));
+				out.put(",\"ts\":");
+				out.put_us(rec.begin - origin);
+				out.put(",\"dur\":");
+				out.put_us(rec.end - rec.begin);
+				if (rec.type != nullptr)
+				{
+					out.put(",\"args\":{\"type\":\"");
+					out.put(rec.type);
+					out.put("\",\"prio\":");
+					out.put(static_cast<std::uint64_t>(rec.prio));
+					out.put("}");
+				}
+				out.put("}");
+			}
+		}
+		out.put("\n]}\n");
+	}
+
+#ifdef _WIN32
+	_close(fd);
+#else
+	::close(fd);
+#endif
+	return true;
+}
+
+//------------------------------
+//----HOOKUP IMPLEMENTATIONS----
+//------------------------------
+
+static char trace_path[256] = "goblins_trace.json";
+
+static void dump_at_exit() { tracer::dump(trace_path); }
+
+#ifndef _WIN32
+static void dump_on_signal(int) { tracer::dump(trace_path); }
+#endif
+
+//sets up dumping before main runs
+static struct trace_hookup {
+	trace_hookup() {
+		const char* path = std::getenv("GOBLINS_TRACE_FILE");
+		if (path != nullptr && std::strlen(path) < sizeof(trace_path))
+			std::strcpy(trace_path, path);
+		std::atexit(dump_at_exit);
+#ifndef _WIN32
+		std::signal(SIGUSR1, dump_on_signal);
+#endif
+	}
+} hookup;
+
+#endif
@@ -0,0 +1,92 @@
+/*
+* Justin W Li
+* trace.h
+* trace recorder class definitions
+* only built with GOBLINS_TRACE defined -- otherwise every GOBLINS_TRACE_ macro expands to nothing, arguments and all
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef GOBLINS_TRACE
+
+#include <atomic>		//std::atomic
+#include <cstddef>		//std::size_t
+#include <cstdint>		//std::uint64_t
+
+//--------------------
+//----TRACER CLASS----
+//--------------------
+
+//records spans of time -- events running, waits on the player, word handler calls -- into a ring per thread,
+//and dumps them as Chrome trace JSON, which chrome://tracing and ui.perfetto.dev both open
+//recording takes no lock, and allocates nothing after a thread's first span; a full ring writes over its oldest spans
+//dumped to the file named by GOBLINS_TRACE_FILE, or "goblins_trace.json", on exit -- and on POSIX, on SIGUSR1
+class tracer {
+public:
+	//one span
+	struct record {
+		const char* name;								//string literals only -- dump may run in a signal handler
+		const char* cat;
+		const char* type;								//type of event span belongs to; nullptr if none
+		int prio;										//priority of that event; -1 if none
+		std::uint64_t begin;							//nanoseconds on steady_clock
+		std::uint64_t end;
+	};
+
+	static const std::size_t RING_SIZE = 1 << 14;		//spans each thread keeps
+	static const unsigned int MAX_THREADS = 64;			//threads past this many are not traced
+
+private:
+	//one thread's spans, oldest written over first
+	struct ring {
+		record records[RING_SIZE];
+		std::atomic<std::uint64_t> written;				//spans recorded so far -- newest is at written - 1
+		unsigned int tid;								//thread's number in dump
+	};
+
+	static std::atomic<ring*> rings[MAX_THREADS];
+	static std::atomic<unsigned int> threads;			//rings handed out, and tried to be
+
+	static ring* local();								//calling thread's ring -- made on its first span; nullptr past MAX_THREADS
+
+public:
+	static std::uint64_t now();
+	static void add(const record& r);					//records span on calling thread's ring
+	static bool dump(const char* path);					//writes every ring out -- async-signal-safe; false if path cannot be written
+};
+
+//span from its construction to the end of its scope
+class trace_scope {
+	const char* name;
+	const char* cat;
+	const char* type;
+	int prio;
+	std::uint64_t begin;
+
+public:
+	trace_scope(const char* name_, const char* cat_, const char* type_ = nullptr, int prio_ = -1) :
+		name(name_), cat(cat_), type(type_), prio(prio_), begin(tracer::now()) {}
+	~trace_scope() { tracer::add({ name, cat, type, prio, begin, tracer::now() }); }
+	trace_scope(const trace_scope&) = delete;
+	trace_scope& operator=(const trace_scope&) = delete;
+};
+
+#define GOBLINS_TRACE_JOIN_(a, b) a##b
+#define GOBLINS_TRACE_JOIN(a, b) GOBLINS_TRACE_JOIN_(a, b)
+
+//traces rest of scope as name, under category cat
+#define GOBLINS_TRACE_SCOPE(name, cat) \
+	trace_scope GOBLINS_TRACE_JOIN(trace_scope_, __LINE__)(name, cat)
+//same, tagged with the type and priority of the event it belongs to
+#define GOBLINS_TRACE_EVENT(name, cat, type, prio) \
+	trace_scope GOBLINS_TRACE_JOIN(trace_scope_, __LINE__)(name, cat, type, prio)
+
+#else
+
+#define GOBLINS_TRACE_SCOPE(name, cat) ((void)0)
+#define GOBLINS_TRACE_EVENT(name, cat, type, prio) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+/*
+* Justin W Li
+* wheel_check.cpp
+* checks timing_wheel against a plain sorted map of the same nodes, over random inserts, cancels and advances
+* usage: wheel_check [steps] [seed]
+*	steps -- random operations made (default 400000)
+*	seed -- seed they are drawn from (default 1)
+* exits with 1 if the wheel and the map disagree on what is due, when, or in what order
+*/
+
+#include "timing_wheel.h"
+#include "rng.h"
+
+#include <algorithm>	//std::min
+#include <cstdio>		//std::printf
+#include <cstdlib>		//std::strtoul, std::strtoull
+#include <map>			//std::multimap
+#include <utility>		//std::make_pair
+#include <vector>		//std::vector
+
+static const std::size_t NODES = 20000;
+
+//tick a node is due at, from a single tick ahead to past the top wheel, or already due
+static std::uint64_t random_due(std::uint64_t now, rng& gen) {
+	switch (gen.bounded(5))
+	{
+	case 0: return now + gen.bounded(64);
+	case 1: return now + gen.bounded(5000);
+	case 2: return now + gen.bounded(300000);
+	case 3: return now + gen.bounded(40000000);
+	default: return now - std::min<std::uint64_t>(now, gen.bounded(3));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned long steps = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 400000;
+	const std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+	rng gen(seed);
+
+	typedef std::multimap<std::uint64_t, std::size_t> reference;
+	timing_wheel wheel;
+	std::vector<wheel_node> nodes(NODES);
+	reference due;									//every node in the wheel, by the tick it is due
+	std::vector<reference::iterator> where(NODES);	//each node's entry in due
+	std::vector<bool> in(NODES, false);
+	unsigned long fired = 0, wrong = 0;
+
+	auto fail = [&wrong](const char* what, unsigned long step) {
+		if (++wrong <= 5)
+			std::printf("step %lu: %s\n", step, what);
+	};
+
+	for (unsigned long step = 0; step < steps; ++step)
+	{
+		const std::size_t i = static_cast<std::size_t>(gen.bounded(NODES));
+		const std::uint64_t op = gen.bounded(10);
+		if (op < 4)
+		{
+			if (in[i])
+				continue;
+			const std::uint64_t tick = random_due(wheel.current(), gen);
+			wheel.insert(&nodes[i], tick);
+			where[i] = due.insert(std::make_pair(tick, i));
+			in[i] = true;
+		}
+		else if (op < 5)
+		{
+			if (!in[i])
+				continue;
+			wheel.cancel(&nodes[i]);
+			due.erase(where[i]);
+			in[i] = false;
+		}
+		else
+		{
+			//mostly a few ticks on, sometimes a long way, sometimes straight to the next wake
+			std::uint64_t to = wheel.current() + (gen.bounded(4) == 0 ? gen.bounded(100000) : gen.bounded(50));
+			if (gen.bounded(3) == 0 && !wheel.empty() && wheel.next_wake() != timing_wheel::NEVER)
+				to = wheel.next_wake();
+			const std::uint64_t before = wheel.current();
+			wheel.advance(to);
+			const std::uint64_t now = wheel.current();
+
+			//what comes out must be exactly what the map has due by now -- nodes inserted already due first, as
+			//they were inserted, then those this advance expired, soonest first
+			std::uint64_t last = 0;
+			while (wheel_node* n = wheel.pop_expired())
+			{
+				const std::size_t k = static_cast<std::size_t>(n - &nodes[0]);
+				if (!in[k])
+					fail("node expired that was not in the wheel", step);
+				else if (n->due > now)
+					fail("node expired before it was due", step);
+				else
+				{
+					if (n->due > before)
+					{
+						if (n->due < last)
+							fail("nodes expired out of order", step);
+						last = n->due;
+					}
+					else if (last != 0)
+						fail("node inserted already due expired after one that came due", step);
+					due.erase(where[k]);
+					in[k] = false;
+				}
+				++fired;
+			}
+			if (!due.empty() && due.begin()->first <= now)
+				fail("node due but not expired", step);
+
+			//next wake may be early, but never later than the first node due, nor before the next tick
+			if (!due.empty())
+			{
+				const std::uint64_t wake = wheel.next_wake();
+				if (wake > due.begin()->first || wake <= now)
+					fail("next wake outside its bounds", step);
+			}
+			else if (!wheel.empty())
+				fail("wheel holds nodes the map does not", step);
+		}
+	}
+
+	std::printf("%lu steps, %lu nodes expired, %lu disagreements\n", steps, fired, wrong);
+	return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,393 @@
+/*
+* Justin W Li
+* word_bank.cpp
+* compiled word bank class implementations
+*/
+
+#include "word_bank.h"
+#include <algorithm>    //std::min, std::max
+#include <cstdint>      //UINT32_MAX
+#include <cstring>      //std::memchr, std::memcpy, std::memcmp
+#include <cstdio>       //std::rename, std::remove
+#include <exception>    //std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <fstream>      //std::ofstream
+#include <future>       //std::async
+#include <mutex>        //std::mutex, std::lock_guard
+#include <string>       //std::string
+#include <system_error> //std::system_error
+#include <thread>       //std::thread
+
+static const char GWB_MAGIC[4] = { 'G', 'W', 'B', '1' };
+
+//returns end of line starting at first, or last if it is the final line
+static const char* find_eol(const char* first, const char* last) {
+	const void* eol = std::memchr(first, '\n', static_cast<std::size_t>(last - first));
+	return eol ? static_cast<const char*>(eol) : last;
+}
+
+//calls fn(word, length) for each line of text -- program expects one word per line
+template <typename Fn>
+static void for_each_line(const char* text, std::size_t size, Fn fn) {
+	const char* const last = text + size;
+	for (const char* line = text; line < last; )
+	{
+		const char* eol = find_eol(line, last);
+		std::size_t len = static_cast<std::size_t>(eol - line);
+		if (len && line[len - 1] == '\r') --len;	//ignore windows line endings
+
+		fn(line, len);
+		line = eol + 1;
+	}
+}
+
+//ctor
+word_bank::word_bank() : file(), image(), header(nullptr), buckets(nullptr), offsets(nullptr), strings(nullptr) {}
+
+//hashes eight bytes at a time -- only needs to notice that words.txt changed
+std::uint64_t word_bank::hash(const char* data, std::size_t size) {
+	const std::uint64_t mul = 0x9E3779B97F4A7C15ull;
+	std::uint64_t h = 0xCBF29CE484222325ull ^ size;
+
+	std::size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		std::uint64_t w;
+		std::memcpy(&w, data + i, 8);
+		h = (h ^ w) * mul;
+		h ^= h >> 32;
+	}
+	for (; i < size; ++i)
+		h = (h ^ static_cast<unsigned char>(data[i])) * mul;
+
+	h ^= h >> 29;
+	return h;
+}
+
+//one thread's share of text -- whole lines, and the words it found of each length
+struct text_chunk {
+	const char* first;
+	const char* last;
+	std::vector<std::uint32_t> count;	//words of each length
+	std::vector<std::uint32_t> slot;	//index of chunk's first word of each length, once laid out
+	std::vector<std::uint32_t> next;	//offset of chunk's first string of each length, once laid out
+	std::vector<const char*> dropped;	//lines the filter blocked, in file order
+};
+
+//runs fn(i) for i in [0, n), each on its own thread -- caller takes i = 0, and any a thread could not be started for
+//the first exception thrown by fn is rethrown here, once every call is done -- one escaping a thread would end the program
+template <typename Fn>
+static void run_parallel(std::size_t n, Fn fn) {
+	std::mutex error_lock;
+	std::exception_ptr error;
+	auto work = [&](std::size_t i) {
+		try {
+			fn(i);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> hold(error_lock);
+			if (!error)
+				error = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(n);
+	for (std::size_t i = 1; i < n; ++i)
+	{
+		try {
+			workers.emplace_back(work, i);
+		}
+		catch (const std::system_error&) {
+			work(i);
+		}
+	}
+	work(0);
+	for (std::thread& w : workers)
+		w.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+//compiles text into a .gwb image
+//text is cut into runs of whole lines, one per thread; each thread counts its words by length, the counts are
+//laid out once in file order, then each thread copies its words straight into their final place
+std::vector<char> word_bank::compile(const char* text, std::size_t size, std::size_t memory_cap, const word_filter* filter) {
+	//small lists are not worth the threads
+	const std::size_t per_thread = std::size_t(1) << 20;
+	std::size_t threads = std::thread::hardware_concurrency();
+	threads = std::max<std::size_t>(1, std::min(threads, size / per_thread));
+
+	//hash is one long chain through the text -- works beside the count pass
+	std::future<std::uint64_t> source_hash = std::async(threads > 1 ? std::launch::async : std::launch::deferred,
+		hash, text, size);
+
+	//cut text after the newline closest past each even share
+	std::vector<text_chunk> chunks(threads);
+	const char* const last = text + size;
+	const char* cut = text;
+	for (std::size_t t = 0; t < threads; ++t)
+	{
+		chunks[t].first = cut;
+		cut = (t + 1 < threads) ? find_eol(std::max(cut, text + size / threads * (t + 1)), last) : last;
+		if (cut < last && t + 1 < threads)
+			++cut;
+		chunks[t].last = cut;
+	}
+
+	//first pass: count words of each length -- and, with a blocklist, note which lines it drops
+	const std::uint64_t filter_print = filter != nullptr ? filter->fingerprint() : 0;
+	if (filter != nullptr && filter->empty())
+		filter = nullptr;
+	run_parallel(threads, [&chunks, filter](std::size_t t) {
+		text_chunk& c = chunks[t];
+		auto count = [&c](std::size_t len) {
+			if (len >= c.count.size())
+				c.count.resize(len + 1, 0);
+			++c.count[len];
+		};
+		if (filter != nullptr)
+			filter->find_blocked(c.first, static_cast<std::size_t>(c.last - c.first), c.dropped);
+		std::size_t drop = 0;
+		for_each_line(c.first, static_cast<std::size_t>(c.last - c.first), [&c, &count, &drop](const char* word, std::size_t len) {
+			if (drop < c.dropped.size() && c.dropped[drop] == word)
+				++drop;
+			else
+				count(len);
+		});
+	});
+
+	std::size_t lengths = 1;
+	for (const text_chunk& c : chunks)
+		lengths = std::max(lengths, c.count.size());
+	std::vector<gwb_bucket> table(lengths, gwb_bucket{ 0, 0 });
+	std::uint64_t words = 0, bytes = 0;
+	for (const text_chunk& c : chunks)
+	{
+		for (std::size_t len = 0; len < c.count.size(); ++len)
+		{
+			table[len].count += c.count[len];
+			words += c.count[len];
+			bytes += static_cast<std::uint64_t>(len) * c.count[len];
+		}
+	}
+
+	//tables index words and strings with 32 bits
+	if (words >= UINT32_MAX || bytes > UINT32_MAX)
+		throw "compile(): word list too large for word bank!\n";
+	const std::size_t table_size = table.size() * sizeof(gwb_bucket);
+	const std::size_t offsets_size = (static_cast<std::size_t>(words) + 1) * sizeof(std::uint32_t);
+	const std::size_t image_size = sizeof(gwb_header) + table_size + offsets_size + static_cast<std::size_t>(bytes);
+	if (memory_cap != 0 && image_size > memory_cap)
+		throw "compile(): word bank exceeds memory cap!\n";
+
+	//lay out buckets by length, and each chunk's share of each bucket in file order
+	std::uint32_t first = 0, offset = 0;
+	for (std::size_t len = 0; len < table.size(); ++len)
+	{
+		table[len].first = first;
+		for (text_chunk& c : chunks)
+		{
+			const std::uint32_t n = len < c.count.size() ? c.count[len] : 0;
+			if (n == 0)
+				continue;
+			if (c.slot.empty())
+			{
+				c.slot.resize(c.count.size());
+				c.next.resize(c.count.size());
+			}
+			c.slot[len] = first;
+			c.next[len] = offset;
+			first += n;
+			offset += static_cast<std::uint32_t>(len * n);
+		}
+	}
+
+	std::vector<char> out(image_size);
+
+	//second pass: place each word after the others of its length, keeping file order
+	std::uint32_t* word_offsets = reinterpret_cast<std::uint32_t*>(out.data() + sizeof(gwb_header) + table_size);
+	char* data = out.data() + sizeof(gwb_header) + table_size + offsets_size;
+	run_parallel(threads, [&chunks, word_offsets, data](std::size_t t) {
+		text_chunk& c = chunks[t];
+		std::size_t drop = 0;
+		for_each_line(c.first, static_cast<std::size_t>(c.last - c.first), [&c, &drop, word_offsets, data](const char* word, std::size_t len) {
+			if (drop < c.dropped.size() && c.dropped[drop] == word)
+			{
+				++drop;
+				return;
+			}
+			word_offsets[c.slot[len]++] = c.next[len];
+			std::memcpy(data + c.next[len], word, len);
+			c.next[len] += static_cast<std::uint32_t>(len);
+		});
+	});
+	word_offsets[words] = static_cast<std::uint32_t>(bytes);
+
+	gwb_header h;
+	std::memcpy(h.magic, GWB_MAGIC, sizeof(h.magic));
+	h.version = VERSION;
+	h.source_size = size;
+	h.source_hash = source_hash.get() ^ filter_print;
+	h.word_count = static_cast<std::uint32_t>(words);
+	h.max_length = static_cast<std::uint32_t>(table.size() - 1);
+	std::memcpy(out.data(), &h, sizeof(h));
+	std::memcpy(out.data() + sizeof(h), table.data(), table_size);
+
+	return out;
+}
+
+//compiles text file into .gwb file
+bool word_bank::compile_file(const char* text_path, const char* bank_path, std::size_t memory_cap,
+	const char* blocklist_path) {
+	mapped_file text;
+	if (!text.open(text_path))
+		return false;
+
+	word_bank bank;
+	try {
+		word_filter filter;
+		if (blocklist_path != nullptr && !filter.load(blocklist_path))
+			return false;
+		bank.build(text.data(), text.size(), memory_cap, &filter);
+	}
+	catch (const char*) {
+		return false;			//too large for a bank, or for the cap
+	}
+	return bank.save(bank_path);
+}
+
+//points tables into a compiled bank; returns false if it is malformed
+//a bank may be stale, truncated or corrupt, and every word is read straight out of it -- so each table is checked
+//in full: buckets must cover the words in length order, and each word take as many letters as its bucket says
+bool word_bank::attach(const char* data, std::size_t size) {
+	if (size < sizeof(gwb_header))
+		return false;
+	const gwb_header* h = reinterpret_cast<const gwb_header*>(data);
+	if (std::memcmp(h->magic, GWB_MAGIC, sizeof(h->magic)) != 0 || h->version != VERSION)
+		return false;
+
+	//every length needs a bucket and every word an offset, so neither count can pass the file's size --
+	//which also keeps the sizes below from overflowing
+	if (h->max_length >= size || h->word_count >= size)
+		return false;
+	const std::uint64_t table_size = (std::uint64_t(h->max_length) + 1) * sizeof(gwb_bucket);
+	const std::uint64_t offsets_size = (std::uint64_t(h->word_count) + 1) * sizeof(std::uint32_t);
+	const std::uint64_t strings_pos = sizeof(gwb_header) + table_size + offsets_size;
+	if (size < strings_pos)
+		return false;
+	const std::uint64_t strings_size = size - strings_pos;
+	const gwb_bucket* table = reinterpret_cast<const gwb_bucket*>(data + sizeof(gwb_header));
+	const std::uint32_t* word_offsets = reinterpret_cast<const std::uint32_t*>(data + sizeof(gwb_header) + table_size);
+
+	//offsets then only ever grow, and the last lands on the end of the file
+	std::uint32_t next = 0;
+	if (word_offsets[0] != 0)
+		return false;
+	for (std::uint32_t len = 0; len <= h->max_length; ++len)
+	{
+		if (table[len].first != next || table[len].count > h->word_count - next)
+			return false;
+		for (std::uint32_t i = next; i < next + table[len].count; ++i)
+		{
+			if (word_offsets[i + 1] != std::uint64_t(word_offsets[i]) + len)
+				return false;
+		}
+		next += table[len].count;
+	}
+	if (next != h->word_count || word_offsets[h->word_count] != strings_size)
+		return false;
+
+	header = h;
+	buckets = table;
+	offsets = word_offsets;
+	strings = data + strings_pos;
+	return true;
+}
+
+//maps .gwb file; returns false if it is missing, malformed, or was not compiled from the given source
+bool word_bank::load(const char* bank_path, std::uint64_t source_size, std::uint64_t source_hash) {
+	if (!load(bank_path))
+		return false;
+	if (header->source_size != source_size || header->source_hash != source_hash)
+	{
+		clear();
+		return false;
+	}
+	return true;
+}
+
+//maps .gwb file without checking its source
+bool word_bank::load(const char* bank_path) {
+	clear();
+	if (!file.open(bank_path))
+		return false;
+	if (!attach(file.data(), file.size()))
+	{
+		clear();
+		return false;
+	}
+	return true;
+}
+
+//compiles text in memory
+void word_bank::build(const char* text, std::size_t size, std::size_t memory_cap, const word_filter* filter) {
+	clear();
+	image = compile(text, size, memory_cap, filter);
+	attach(image.data(), image.size());
+}
+
+//writes bank to disk
+bool word_bank::save(const char* bank_path) const {
+	if (empty())
+		return false;
+
+	const std::size_t size = memory();
+
+	//written beside the old file, then renamed over it -- a bank still mapping the old file keeps it intact
+	const std::string temp_path = std::string(bank_path) + ".tmp";
+	{
+		std::ofstream out(temp_path, std::ofstream::binary | std::ofstream::trunc);
+		if (!out.is_open())
+			return false;
+		out.write(reinterpret_cast<const char*>(header), static_cast<std::streamsize>(size));
+		if (!out)
+		{
+			out.close();
+			std::remove(temp_path.c_str());
+			return false;
+		}
+	}
+
+#ifdef _WIN32
+	//rename will not replace a file here; fails, leaving the old cache, while that file is mapped
+	std::remove(bank_path);
+#endif
+	if (std::rename(temp_path.c_str(), bank_path) != 0)
+	{
+		std::remove(temp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+//bytes of bank -- header, tables and strings
+std::size_t word_bank::memory() const {
+	if (empty())
+		return 0;
+	return sizeof(gwb_header)
+		+ (max_length() + 1) * sizeof(gwb_bucket)
+		+ (size() + 1) * sizeof(std::uint32_t)
+		+ offsets[size()];
+}
+
+//releases bank
+void word_bank::clear() {
+	header = nullptr;
+	buckets = nullptr;
+	offsets = nullptr;
+	strings = nullptr;
+	file.close();
+	image.clear();
+	image.shrink_to_fit();
+}
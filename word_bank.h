@@ -0,0 +1,97 @@
+/*
+* Justin W Li
+* word_bank.h
+* compiled word bank class definition
+*/
+
+#ifndef WORD_BANK_H
+#define WORD_BANK_H
+
+#include "mapped_file.h"
+#include "word_store.h"
+#include "word_filter.h"
+
+#include <cstddef>		//std::size_t
+#include <cstdint>		//std::uint32_t, std::uint64_t
+#include <string_view>	//std::string_view
+#include <vector>		//std::vector
+
+//compiled word bank (.gwb) layout -- every field in the compiling machine's byte order; a bank from a machine of
+//the other order fails its version check, and is rebuilt from words.txt or refused
+//	gwb_header
+//	gwb_bucket[max_length + 1]		one entry per word length
+//	uint32_t[word_count + 1]		offset of each word in string data; last entry is total size
+//	char[]							string data, words packed back to back and sorted by length
+struct gwb_header {
+	char magic[4];						//"GWB1"
+	std::uint32_t version;				//format version
+	std::uint64_t source_size;			//size of the words.txt this was compiled from
+	std::uint64_t source_hash;			//hash of the words.txt this was compiled from, xor blocklist fingerprint
+	std::uint32_t word_count;			//number of words in bank
+	std::uint32_t max_length;			//length of longest word in bank
+};
+
+struct gwb_bucket {
+	std::uint32_t first;				//index of first word with this length
+	std::uint32_t count;				//number of words with this length
+};
+
+//read-only word bank, bucketed by length
+//either maps a compiled .gwb file, or compiles words.txt into memory
+class word_bank : public word_store {
+	mapped_file file;					//mapped .gwb -- backs the pointers below when loaded from disk
+	std::vector<char> image;			//compiled bank -- backs the pointers below when built from text
+
+	const gwb_header* header;			//start of bank
+	const gwb_bucket* buckets;			//per-length offset table
+	const std::uint32_t* offsets;		//per-word offsets into strings
+	const char* strings;				//packed string data
+
+	bool attach(const char* data, std::size_t size);	//points tables into a compiled bank; false if malformed
+
+public:
+	static const std::uint32_t VERSION = 1;
+
+	word_bank();
+	word_bank(const word_bank&) = delete;
+	word_bank& operator=(const word_bank&) = delete;
+
+	//library api
+	static std::uint64_t hash(const char* data, std::size_t size);				//hash used to detect stale banks
+	static std::vector<char> compile(const char* text, std::size_t size,
+		std::size_t memory_cap = 0, const word_filter* filter = nullptr);		//compiles one-word-per-line text into .gwb image, split
+																				//between hardware threads; throws if image would be
+																				//larger than memory_cap bytes (0 for no cap);
+																				//leaves out words filter blocks
+	static bool compile_file(const char* text_path, const char* bank_path,
+		std::size_t memory_cap = 0, const char* blocklist_path = nullptr);		//compiles text file into .gwb file
+
+	//loading
+	bool load(const char* bank_path, std::uint64_t source_size, std::uint64_t source_hash);	//maps .gwb; false if missing or stale
+	bool load(const char* bank_path);											//maps .gwb without checking its source
+	void build(const char* text, std::size_t size, std::size_t memory_cap = 0,
+		const word_filter* filter = nullptr);									//compiles text in memory
+	bool save(const char* bank_path) const;										//writes bank to disk; false on failure
+	void clear();																//releases bank
+
+	//access
+	bool empty() const { return header == nullptr; }
+	std::size_t size() const { return header ? header->word_count : 0; }			//number of words
+	std::size_t max_length() const { return header ? header->max_length : 0; }		//length of longest word
+	std::size_t memory() const;														//bytes of bank, mapped or in memory
+	std::size_t count(std::size_t len) const {										//number of words with length len
+		return len <= max_length() ? buckets[len].count : 0;
+	}
+	std::size_t first(std::size_t len) const {										//index of first word with length len or longer
+		return len <= max_length() ? buckets[len].first : size();
+	}
+	std::string_view word(std::size_t len, std::size_t i) const {					//i-th word with length len
+		return word(buckets[len].first + i);
+	}
+	std::string_view word(std::size_t index) const {								//word at index, in length order
+		return std::string_view(strings + offsets[index], offsets[index + 1] - offsets[index]);
+	}
+	std::string_view word(std::size_t index, char*) const { return word(index); }	//packed words never need spelling out
+};
+
+#endif
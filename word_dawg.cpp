@@ -0,0 +1,281 @@
+/*
+* Justin W Li
+* word_dawg.cpp
+* minimized word graph (dawg) class implementations
+*/
+
+#include "word_dawg.h"
+#include <algorithm>        //std::sort, std::equal, std::upper_bound
+#include <cstdint>          //UINT32_MAX, SIZE_MAX
+
+//hashes a node or count run, one 32-bit word at a time
+static std::uint32_t mix(std::uint64_t h, std::uint32_t w) {
+	h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+	return static_cast<std::uint32_t>(h ^ (h >> 32));
+}
+
+//open-addressed set of ids, found by hash -- what an id stands for is kept elsewhere, so the table holds
+//nothing but the id and its hash, and grows without looking anything up again
+class signature_table {
+	std::vector<std::uint64_t> slots;	//hash in high 32 bits, id + 1 in low 32; 0 if empty
+	std::size_t used;
+
+	void grow() {
+		std::vector<std::uint64_t> old(slots.size() * 2, 0);
+		old.swap(slots);
+		const std::size_t mask = slots.size() - 1;
+		for (std::uint64_t s : old)
+		{
+			if (s == 0)
+				continue;
+			std::size_t i = static_cast<std::size_t>(s >> 32) & mask;
+			while (slots[i] != 0)
+				i = (i + 1) & mask;
+			slots[i] = s;
+		}
+	}
+
+public:
+	static const std::uint32_t NONE = UINT32_MAX;
+
+	signature_table() : slots(1024, 0), used(0) {}
+
+	//id with hash for which same(id) holds; NONE if there is none
+	template <typename Same>
+	std::uint32_t find(std::uint32_t hash, Same same) const {
+		const std::size_t mask = slots.size() - 1;
+		for (std::size_t i = hash & mask; slots[i] != 0; i = (i + 1) & mask)
+		{
+			const std::uint32_t id = static_cast<std::uint32_t>(slots[i]) - 1;
+			if (static_cast<std::uint32_t>(slots[i] >> 32) == hash && same(id))
+				return id;
+		}
+		return NONE;
+	}
+
+	void insert(std::uint32_t hash, std::uint32_t id) {
+		if (++used * 2 > slots.size())
+			grow();
+		const std::size_t mask = slots.size() - 1;
+		std::size_t i = hash & mask;
+		while (slots[i] != 0)
+			i = (i + 1) & mask;
+		slots[i] = (std::uint64_t(hash) << 32) | (id + 1);
+	}
+};
+
+//ctor
+word_dawg::word_dawg() : graph(), counts(), starts(), root(0), node_count(0) {}
+
+//builds graph from every word in bank, in sorted order
+//once a word stops sharing a node's path, nothing else can be added under that node, so it is finished right away --
+//merged with any finished node that has the same edges and ends as many words, or else laid out after the last
+void word_dawg::build(const word_bank& bank) {
+	clear();
+	if (bank.size() == 0)
+		return;
+
+	const std::size_t max_len = bank.max_length();
+	if (max_len > MAX_LENGTH)
+		throw "word_dawg::build(): words too long for word graph!\n";
+
+	//bank is in length order; words go in by letter
+	std::vector<std::uint32_t> order(bank.size());
+	for (std::size_t i = 0; i < order.size(); ++i)
+		order[i] = static_cast<std::uint32_t>(i);
+	std::sort(order.begin(), order.end(), [&bank](std::uint32_t a, std::uint32_t b) {
+		return bank.word(a) < bank.word(b);
+	});
+
+	signature_table nodes_seen;					//finished nodes, by position
+	signature_table runs_seen;					//count runs, by position
+	std::vector<std::uint64_t> tally(max_len + 1, 0);	//words below node being finished, by letters left
+	std::vector<std::uint32_t> run;				//count run of node being finished
+
+	//finishes node with given edges, at which ends words end; returns its position
+	auto finish = [&](std::vector<std::uint32_t>& out, std::uint32_t ends) -> std::uint32_t {
+		//count words below node by letters left, from its children's runs
+		std::size_t lo = SIZE_MAX, hi = 0;
+		if (ends != 0)
+		{
+			tally[0] = ends;
+			lo = 0;
+		}
+		for (std::uint32_t e : out)
+		{
+			const std::uint32_t header = graph[e >> 9];
+			const std::size_t shift = (header >> 22) + 1;
+			for (std::uint32_t i = header & (MAX_COUNTS - 1); ; ++i)
+			{
+				const std::size_t left = shift + (counts[i] >> 22);
+				tally[left] += counts[i] & (MAX_COUNT - 1);
+				lo = std::min(lo, left);
+				hi = std::max(hi, left);
+				if ((counts[i] & END) != 0)
+					break;
+			}
+		}
+		run.clear();
+		for (std::size_t left = lo; left <= hi; ++left)
+		{
+			if (tally[left] == 0)
+				continue;
+			if (tally[left] >= MAX_COUNT)
+				throw "word_dawg::build(): too many words for word graph!\n";
+			run.push_back(static_cast<std::uint32_t>(((left - lo) << 22) | tally[left]));
+			tally[left] = 0;
+		}
+		run.back() |= END;
+
+		//runs are shared by every node with the same counts, however many letters those start after
+		std::uint32_t run_hash = 0;
+		for (std::uint32_t w : run)
+			run_hash = mix(run_hash, w);
+		std::uint32_t c = runs_seen.find(run_hash, [&](std::uint32_t pos) {
+			return counts.size() - pos >= run.size() && std::equal(run.begin(), run.end(), counts.begin() + pos);
+		});
+		if (c == signature_table::NONE)
+		{
+			c = static_cast<std::uint32_t>(counts.size());
+			if (counts.size() + run.size() > MAX_COUNTS)
+				throw "word_dawg::build(): too many nodes!\n";
+			counts.insert(counts.end(), run.begin(), run.end());
+			runs_seen.insert(run_hash, c);
+		}
+
+		//nodes with the same header end as many words, so with the same edges they are the same node
+		const std::uint32_t header = static_cast<std::uint32_t>(lo << 22) | c;
+		if (!out.empty())
+			out.back() |= LAST;
+		std::uint32_t node_hash = mix(0, header);
+		for (std::uint32_t e : out)
+			node_hash = mix(node_hash, e);
+		std::uint32_t node = nodes_seen.find(node_hash, [&](std::uint32_t pos) {
+			return graph[pos] == header && std::equal(out.begin(), out.end(), graph.begin() + pos + 1);
+		});
+		if (node == signature_table::NONE)
+		{
+			node = static_cast<std::uint32_t>(graph.size());
+			if (graph.size() + 1 + out.size() > MAX_GRAPH)
+				throw "word_dawg::build(): too many nodes!\n";
+			graph.push_back(header);
+			graph.insert(graph.end(), out.begin(), out.end());
+			nodes_seen.insert(node_hash, node);
+			++node_count;
+		}
+		return node;
+	};
+
+	std::vector<std::vector<std::uint32_t>> path(max_len + 1);	//edges of unfinished nodes along the last word added, by depth
+	std::vector<std::uint32_t> ends(max_len + 1, 0);			//times the last word's prefix of each depth was added
+	std::string_view prev;
+
+	//finishes nodes deeper than depth, pointing their parents' last edges at what they became
+	auto finish_below = [&](std::size_t depth) {
+		for (std::size_t d = prev.size(); d-- > depth; )
+		{
+			path[d].back() |= finish(path[d + 1], ends[d + 1]) << 9;
+			path[d + 1].clear();
+			ends[d + 1] = 0;
+		}
+	};
+
+	for (std::uint32_t i : order)
+	{
+		const std::string_view w = bank.word(i);
+		std::size_t shared = 0;
+		while (shared < prev.size() && shared < w.size() && prev[shared] == w[shared])
+			++shared;
+		finish_below(shared);
+
+		for (std::size_t d = shared; d < w.size(); ++d)
+			path[d].push_back(static_cast<unsigned char>(w[d]));
+		++ends[w.size()];
+		prev = w;
+	}
+	finish_below(0);
+	root = finish(path[0], ends[0]);
+
+	//root's counts are the number of words of each length
+	starts.assign(max_len + 2, 0);
+	const std::uint32_t header = graph[root];
+	for (std::uint32_t i = header & (MAX_COUNTS - 1); ; ++i)
+	{
+		starts[(header >> 22) + (counts[i] >> 22) + 1] = counts[i] & (MAX_COUNT - 1);
+		if ((counts[i] & END) != 0)
+			break;
+	}
+	for (std::size_t len = 1; len < starts.size(); ++len)
+		starts[len] += starts[len - 1];
+
+	graph.shrink_to_fit();
+	counts.shrink_to_fit();
+}
+
+//releases graph
+void word_dawg::clear() {
+	std::vector<std::uint32_t>().swap(graph);
+	std::vector<std::uint32_t>().swap(counts);
+	std::vector<std::uint32_t>().swap(starts);
+	root = 0;
+	node_count = 0;
+}
+
+std::size_t word_dawg::size() const { return starts.empty() ? 0 : starts.back(); }
+std::size_t word_dawg::max_length() const { return starts.empty() ? 0 : starts.size() - 2; }
+std::size_t word_dawg::first(std::size_t len) const { return len < starts.size() ? starts[len] : size(); }
+
+//runs are sorted by letters left, and short -- one count per length of word below node
+std::uint32_t word_dawg::words_left(std::uint32_t node, std::size_t left) const {
+	const std::uint32_t header = graph[node];
+	const std::size_t lo = header >> 22;
+	if (left < lo)
+		return 0;
+	const std::size_t key = left - lo;
+	for (std::uint32_t i = header & (MAX_COUNTS - 1); ; ++i)
+	{
+		const std::size_t at = counts[i] >> 22;
+		if (at >= key)
+			return at == key ? counts[i] & (MAX_COUNT - 1) : 0;
+		if ((counts[i] & END) != 0)
+			return 0;
+	}
+}
+
+//spells out word at index -- k-th word of its length, in sorted order
+std::string_view word_dawg::word(std::size_t index, char* buf) const {
+	//find length of word
+	const std::size_t len = static_cast<std::size_t>(
+		std::upper_bound(starts.begin() + 1, starts.end(), index) - starts.begin()) - 1;
+
+	//at each node, skip past edges whose words of this length all come before the one wanted
+	std::size_t k = index - starts[len];
+	std::uint32_t node = root;
+	for (std::size_t d = 0; d < len; ++d)
+	{
+		const std::size_t left = len - d - 1;
+		for (std::uint32_t e = node + 1; ; ++e)
+		{
+			const std::uint32_t child = graph[e] >> 9;
+			const std::size_t n = words_left(child, left);
+			if (k < n || (graph[e] & LAST) != 0)
+			{
+				buf[d] = static_cast<char>(graph[e] & 0xFF);
+				node = child;
+				break;
+			}
+			k -= n;
+		}
+	}
+	return std::string_view(buf, len);
+}
+
+//a graph cut short by build's limits holds fewer words, and is never kept
+bool word_dawg::replaces(const word_bank& bank) const {
+	return size() == bank.size() && memory() < bank.memory();
+}
+
+//bytes of graph and its tables
+std::size_t word_dawg::memory() const {
+	return (graph.capacity() + counts.capacity() + starts.capacity()) * sizeof(std::uint32_t);
+}
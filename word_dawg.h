@@ -0,0 +1,61 @@
+/*
+* Justin W Li
+* word_dawg.h
+* minimized word graph (dawg) class definition
+*/
+
+#ifndef WORD_DAWG_H
+#define WORD_DAWG_H
+
+#include "word_store.h"
+#include "word_bank.h"
+
+#include <cstdint>		//std::uint32_t
+#include <vector>		//std::vector
+
+//word bank stored as a minimized directed acyclic word graph
+//every word hangs off one root, so words share both their starts and their endings ("un-", "-ing", "-tion")
+//each node counts the words below it by how many letters they have left, so the k-th word of a length is found
+//in one walk down -- those counts are kept once per distinct run of them, shifted to start at their shortest word
+//words repeated in the bank are kept as often as they appear, so every length holds as many words as the packed
+//bank does -- but in sorted order rather than file order, so a seed draws other words than it would from that bank
+//only smaller than the packed bank for lists with many shared affixes, as natural languages have; never for
+//random letters
+class word_dawg : public word_store {
+	std::vector<std::uint32_t> graph;		//nodes back to back -- each a header, then its edges
+											//header: where node's counts start in counts, fewest letters left below it
+											//in top 10 bits
+											//edge: letter in low 8 bits, LAST bit if node's last edge, node it leads to above them
+	std::vector<std::uint32_t> counts;		//runs of counts back to back -- each count in low 21 bits, END bit if run's
+											//last, letters left past the run's fewest in top 10 bits
+	std::vector<std::uint32_t> starts;		//index of first word of each length; last entry is number of words
+	std::uint32_t root;						//position of root in graph
+	std::uint32_t node_count;
+
+	std::uint32_t words_left(std::uint32_t node, std::size_t left) const;	//words below node with left letters to go
+
+public:
+	static const std::uint32_t LAST = 1u << 8;			//marks a node's last edge
+	static const std::uint32_t END = 1u << 21;			//marks a run's last count
+	static const std::uint32_t MAX_GRAPH = 1u << 23;	//edges have 23 bits to name a node
+	static const std::uint32_t MAX_COUNTS = 1u << 22;	//headers have 22 bits to name a run
+	static const std::uint32_t MAX_COUNT = 1u << 21;	//most words of one length below one node
+	static const std::size_t MAX_LENGTH = 1023;			//letters left have 10 bits
+
+	word_dawg();
+
+	void build(const word_bank& bank);		//builds graph of every word in bank; throws if it is too large for one
+	void clear();							//releases graph
+	std::size_t nodes() const { return node_count; }
+	bool replaces(const word_bank& bank) const;	//whether graph holds every word of bank in fewer bytes -- the DAWG
+											//backend is only kept then
+
+	//word_store
+	std::size_t size() const;
+	std::size_t max_length() const;
+	std::size_t first(std::size_t len) const;
+	std::string_view word(std::size_t index, char* buf) const;
+	std::size_t memory() const;
+};
+
+#endif
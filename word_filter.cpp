@@ -0,0 +1,353 @@
+/*
+* Justin W Li
+* word_filter.cpp
+* blocklist filter class implementations
+*/
+
+#include "word_filter.h"
+#include "word_bank.h"
+#include "mapped_file.h"
+#include <algorithm>    //std::min, std::max, std::copy
+#include <cstring>      //std::memchr
+#include <string>       //std::string
+
+//table entry for a move that finishes a pattern -- no state is numbered this high
+template<class T>
+static constexpr T MATCH = static_cast<T>(~T(0));
+
+//where a move's row starts -- narrow moves name their state, wide ones the row itself
+static const std::size_t NARROW_ROW = 32;
+static inline std::size_t row_of(std::uint16_t state) { return static_cast<std::size_t>(state) * NARROW_ROW; }
+static inline std::size_t row_of(std::uint32_t row) { return row; }
+
+//upper case of an ascii letter; other bytes are left alone -- carriage returns end lines just like newlines
+static inline unsigned char fold(char c) {
+	unsigned char u = static_cast<unsigned char>(c);
+	if (u == '\r')
+		return '\n';
+	return (static_cast<unsigned int>(u - 'a') < 26u) ? static_cast<unsigned char>(u - ('a' - 'A')) : u;
+}
+
+//ctor
+word_filter::word_filter() : classes(), class_count(1), narrow(1, 0), wide(), start(0), print(0) {}
+
+//builds from blocklist file
+bool word_filter::load(const char* path) {
+	mapped_file file;
+	if (!file.open(path))
+		return false;
+	build(file.data(), file.size());
+	return true;
+}
+
+//calls fn(key, at_start, at_end) for every pattern of blocklist text -- key is what lies between its anchors, as written
+template<class Fn>
+static void for_each_pattern(const char* patterns, std::size_t size, Fn fn) {
+	const char* const last = patterns + size;
+	for (const char* line = patterns; line < last; )
+	{
+		const void* eol = std::memchr(line, '\n', static_cast<std::size_t>(last - line));
+		const char* const end = eol ? static_cast<const char*>(eol) : last;
+		std::string_view p(line, static_cast<std::size_t>(end - line));
+		line = end + 1;
+
+		if (!p.empty() && p.back() == '\r')
+			p.remove_suffix(1);
+		if (p.empty() || p[0] == '#')
+			continue;
+		const bool at_start = p[0] == '^';
+		if (at_start)
+			p.remove_prefix(1);
+		const bool at_end = !p.empty() && p.back() == '$';
+		if (at_end)
+			p.remove_suffix(1);
+		if (!p.empty())						//anchors alone would block everything
+			fn(p, at_start, at_end);
+	}
+}
+
+//hash of blocklist text, never 0 unless there is none
+std::uint64_t word_filter::fingerprint(const char* patterns, std::size_t size) {
+	return size == 0 ? 0 : word_bank::hash(patterns, size) | 1;
+}
+
+//reads every pattern, anchors as newlines, and gives every byte they use its own class, then lays the automaton out in
+//the narrowest table that holds it -- every state but the root is reached on a pattern's letter that is not its last
+void word_filter::build(const char* patterns, std::size_t size) {
+	clear();
+	print = fingerprint(patterns, size);
+
+	std::vector<unsigned char> keys;							//every pattern's letters back to back, folded
+	std::vector<std::uint32_t> key_start(1, 0);					//where each starts; last entry is where they end
+	std::size_t rows = 1;
+	keys.reserve(size);
+	for_each_pattern(patterns, size, [this, &keys, &key_start, &rows](std::string_view p, bool at_start, bool at_end) {
+		if (at_start)
+			keys.push_back('\n');
+		for (char c : p)
+			keys.push_back(fold(c));
+		if (at_end)
+			keys.push_back('\n');
+		for (std::size_t i = key_start.back(); i < keys.size(); ++i)
+		{
+			unsigned char& cls = classes[keys[i]];
+			if (cls == 0)
+				cls = static_cast<unsigned char>(class_count++);
+		}
+		rows += keys.size() - key_start.back() - 1;
+		key_start.push_back(static_cast<std::uint32_t>(keys.size()));
+	});
+	if (class_count == 1)
+		return;
+
+	for (unsigned int c = 'a'; c <= 'z'; ++c)
+		classes[c] = classes[c - ('a' - 'A')];
+	classes[static_cast<unsigned char>('\r')] = classes[static_cast<unsigned char>('\n')];
+	if (rows < MATCH<std::uint16_t> && class_count <= NARROW_ROW)
+		lay_out(narrow, keys, key_start, rows, NARROW_ROW);
+	else
+	{
+		if (rows >= MAX_TABLE / class_count)
+			throw "word_filter::build(): blocklist too large!\n";
+		narrow.clear();
+		lay_out(wide, keys, key_start, rows, class_count);
+	}
+}
+
+//builds trie of every pattern straight into the table, a level at a time, so states are numbered breadth first -- the
+//shallow states a scan spends most of its time in end up side by side
+//then fills in each state's missing moves in that order -- a state's failure is the longest end of its text that
+//starts some pattern, so it is always shallower, and its row is finished by the time it is needed: a row starts as a
+//copy of its failure's, and its own moves go back on top
+//a pattern's last letter moves to MATCH rather than to a state, and so does any move whose failure moves to MATCH --
+//a pattern ends there too -- so the states past them are never reached
+template<class T>
+void word_filter::lay_out(std::vector<T>& moves, const std::vector<unsigned char>& keys,
+	const std::vector<std::uint32_t>& key_start, std::size_t rows, std::size_t width) {
+	//narrow moves count states, wide ones count rows
+	const std::size_t per_state = row_of(T(1)) == 1 ? width : 1;
+	std::size_t longest = 0;
+	for (std::size_t k = 0; k + 1 < key_start.size(); ++k)
+		longest = std::max<std::size_t>(longest, key_start[k + 1] - key_start[k]);
+
+	//trie -- 0 is the root, and no move leads to it; each state lists the classes it has a move on, as edges
+	moves.assign(rows * width, 0);
+	std::vector<std::uint32_t> first_edge(rows, 0);			//0 if none
+	std::vector<std::uint32_t> next_edge(1, 0);
+	std::vector<unsigned char> edge_class(1, 0);
+	next_edge.reserve(keys.size() + 1);
+	edge_class.reserve(keys.size() + 1);
+	std::vector<T> at(key_start.size() - 1, 0);				//state each pattern has reached, MATCH once it needs no more
+	std::size_t states = 1;
+	for (std::size_t depth = 0; depth < longest; ++depth)
+	{
+		for (std::size_t k = 0; k < at.size(); ++k)
+		{
+			const std::size_t length = key_start[k + 1] - key_start[k];
+			if (depth >= length || at[k] == MATCH<T>)
+				continue;
+			const unsigned char cls = classes[keys[key_start[k] + depth]];
+			T& to = moves[row_of(at[k]) + cls];
+			if (to == 0)
+			{
+				const std::size_t from = row_of(at[k]) / width;
+				next_edge.push_back(first_edge[from]);
+				edge_class.push_back(cls);
+				first_edge[from] = static_cast<std::uint32_t>(next_edge.size() - 1);
+				if (depth + 1 < length)
+					to = static_cast<T>(states++ * per_state);
+			}
+			if (depth + 1 == length)
+				to = MATCH<T>;							//any longer pattern through here is never reached now
+			at[k] = to;									//MATCH too if a shorter pattern already blocks every word this
+														//one would
+		}
+	}
+
+	//automaton -- root's missing moves stay at root
+	std::vector<T> fail(states, 0);
+	std::vector<std::pair<unsigned char, T>> own;			//moves of the state being laid out, before its row is overwritten
+	for (std::size_t state = 0; state < states; ++state)
+	{
+		T* const row = &moves[state * width];
+		const T* const fail_row = &moves[row_of(fail[state])];
+		own.clear();
+		for (std::uint32_t e = first_edge[state]; e != 0; e = next_edge[e])
+			own.emplace_back(edge_class[e], row[edge_class[e]]);
+		if (state != 0)
+			std::copy(fail_row, fail_row + width, row);
+
+		for (const std::pair<unsigned char, T>& m : own)
+		{
+			const T next_fail = state == 0 ? 0 : fail_row[m.first];
+			if (m.second == MATCH<T> || next_fail == MATCH<T>)
+				row[m.first] = MATCH<T>;
+			else
+			{
+				row[m.first] = m.second;
+				fail[row_of(m.second) / width] = next_fail;
+			}
+		}
+	}
+
+	moves.resize(states * width);
+	start = moves[classes[static_cast<unsigned char>('\n')]];
+}
+
+//blocks nothing
+void word_filter::clear() {
+	for (unsigned char& cls : classes)
+		cls = 0;
+	class_count = 1;
+	narrow.assign(1, 0);
+	wide.clear();
+	start = 0;
+	print = 0;
+}
+
+//runs word through automaton between two newlines, as it would sit in a word list
+template<class T>
+bool word_filter::run(const std::vector<T>& moves, std::string_view word) const {
+	T state = static_cast<T>(start);
+	for (char c : word)
+	{
+		state = moves[row_of(state) + classes[static_cast<unsigned char>(c)]];
+		if (state == MATCH<T>)
+			return true;
+	}
+	return moves[row_of(state) + classes[static_cast<unsigned char>('\n')]] == MATCH<T>;
+}
+
+bool word_filter::blocks(std::string_view word) const {
+	return narrow.empty() ? run(wide, word) : run(narrow, word);
+}
+
+//scans text in LANES runs of whole lines, side by side -- each step waits on the table read before it, so a single
+//run leaves the processor idle between them, and the other runs fill that time
+//newlines are part of the scan, so no line restarts it; the scan only stops on a match, looks back for the start of
+//its line, and goes on from the newline state -- anything else it finds before the line's own newline is in the same
+//line, and that newline brings every state back to the same place -- an anchor at the end matches on the newline after
+//its line, so that newline is not looked at
+template<class T>
+void word_filter::scan(const std::vector<T>& moves, const char* text, std::size_t size,
+	std::vector<const char*>& blocked) const {
+	const std::size_t LANES = 8;
+	const char* const last = text + size;
+	std::vector<const char*> more[LANES - 1];
+	const char* first[LANES];
+	const char* end[LANES];
+	const char* cut = text;
+	for (std::size_t i = 0; i < LANES; ++i)
+	{
+		first[i] = cut;
+		if (i + 1 < LANES)
+		{
+			const char* from = std::max(cut, text + size / LANES * (i + 1));
+			const void* eol = from < last ? std::memchr(from, '\n', static_cast<std::size_t>(last - from)) : nullptr;
+			cut = eol ? static_cast<const char*>(eol) + 1 : last;
+		}
+		else
+			cut = last;
+		end[i] = cut;
+	}
+
+	//notes line a match at p is in, once
+	auto matched = [&blocked, &more, &first](std::size_t lane, const char* p) {
+		const char* line = p;
+		while (line > first[lane] && line[-1] != '\n')
+			--line;
+		std::vector<const char*>& lines = lane == 0 ? blocked : more[lane - 1];
+		if (lines.empty() || lines.back() != line)
+			lines.push_back(line);
+	};
+
+	//table and classes in locals, so the loop below keeps them in registers
+	const T* const table = moves.data();
+	const unsigned char* const cls = classes;
+	const T line_start = static_cast<T>(start);
+	auto step = [table, cls](T state, char c) { return table[row_of(state) + cls[static_cast<unsigned char>(c)]]; };
+
+	//all together while every lane has text left -- a match leaves the loop, so it calls nothing, and every state
+	//stays in a register
+	std::size_t together = size;
+	for (std::size_t i = 0; i < LANES; ++i)
+		together = std::min(together, static_cast<std::size_t>(end[i] - first[i]));
+	const char* const p0 = first[0];
+	const char* const p1 = first[1];
+	const char* const p2 = first[2];
+	const char* const p3 = first[3];
+	const char* const p4 = first[4];
+	const char* const p5 = first[5];
+	const char* const p6 = first[6];
+	const char* const p7 = first[7];
+	T state[LANES];
+	for (T& s : state)
+		s = line_start;
+	for (std::size_t n = 0; n < together; ++n)
+	{
+		T s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];
+		T s4 = state[4], s5 = state[5], s6 = state[6], s7 = state[7];
+		for (; n < together; ++n)
+		{
+			s0 = step(s0, p0[n]);
+			s1 = step(s1, p1[n]);
+			s2 = step(s2, p2[n]);
+			s3 = step(s3, p3[n]);
+			s4 = step(s4, p4[n]);
+			s5 = step(s5, p5[n]);
+			s6 = step(s6, p6[n]);
+			s7 = step(s7, p7[n]);
+			if (s0 == MATCH<T> || s1 == MATCH<T> || s2 == MATCH<T> || s3 == MATCH<T>
+				|| s4 == MATCH<T> || s5 == MATCH<T> || s6 == MATCH<T> || s7 == MATCH<T>)
+				break;
+		}
+		state[0] = s0;
+		state[1] = s1;
+		state[2] = s2;
+		state[3] = s3;
+		state[4] = s4;
+		state[5] = s5;
+		state[6] = s6;
+		state[7] = s7;
+		if (n == together)
+			break;
+		for (std::size_t i = 0; i < LANES; ++i)
+		{
+			if (state[i] == MATCH<T>)
+			{
+				matched(i, first[i] + n);
+				state[i] = line_start;
+			}
+		}
+	}
+
+	//then each on its own
+	for (std::size_t i = 0; i < LANES; ++i)
+	{
+		T s = state[i];
+		const char* p = first[i] + together;
+		for (; p < end[i]; ++p)
+		{
+			s = step(s, *p);
+			if (s == MATCH<T>)
+			{
+				matched(i, p);
+				s = line_start;
+			}
+		}
+
+		//last line has no newline to end it; patterns anchored to the end still need one
+		if (p > first[i] && p[-1] != '\n' && step(s, '\n') == MATCH<T>)
+			matched(i, p);
+	}
+
+	for (const std::vector<const char*>& m : more)
+		blocked.insert(blocked.end(), m.begin(), m.end());
+}
+
+void word_filter::find_blocked(const char* text, std::size_t size, std::vector<const char*>& blocked) const {
+	if (narrow.empty())
+		scan(wide, text, size, blocked);
+	else
+		scan(narrow, text, size, blocked);
+}
@@ -0,0 +1,61 @@
+/*
+* Justin W Li
+* word_filter.h
+* blocklist filter class definition
+*/
+
+#ifndef WORD_FILTER_H
+#define WORD_FILTER_H
+
+#include <cstddef>		//std::size_t
+#include <cstdint>		//std::uint32_t, std::uint64_t
+#include <string_view>	//std::string_view
+#include <vector>		//std::vector
+
+//aho-corasick automaton over a blocklist -- finds every pattern in one pass over a word list, whatever the number of patterns
+//blocklist is one pattern per line, ignoring ascii case; blank lines and lines starting with # are skipped
+//	abc		blocks words containing abc
+//	^abc	blocks words starting with abc
+//	abc$	blocks words ending with abc
+//	^abc$	blocks the word abc
+//anchors are newlines in the automaton, so a scan that runs straight through the list's newlines matches them for free
+//a state that finishes a pattern has no row -- a line is blocked once anything matches it, so the scan goes on from a
+//newline's state, and only needs moves into it marked
+//blocklists of plain words take the narrow table, whose rows are each one cache line and whose moves are 16 bits, so
+//the rows a scan keeps coming back to stay in cache
+class word_filter {
+	unsigned char classes[256];				//letter class of each byte -- folded case; bytes in no pattern share class 0
+	std::size_t class_count;				//number of letter classes
+	std::vector<std::uint16_t> narrow;		//table for under 65535 states of up to 32 classes, otherwise empty -- rows of 32
+											//moves, each the state it leads to, or all bits set if it finishes a pattern
+	std::vector<std::uint32_t> wide;		//table for every other blocklist, otherwise empty -- rows of class_count moves,
+											//each where the row it leads to starts, or all bits set if it finishes a pattern
+	std::uint32_t start;					//move after a newline -- where every word starts
+	std::uint64_t print;					//fingerprint of blocklist
+
+	template<class T> void lay_out(std::vector<T>& moves, const std::vector<unsigned char>& keys,
+		const std::vector<std::uint32_t>& key_start, std::size_t rows, std::size_t width);
+	template<class T> bool run(const std::vector<T>& moves, std::string_view word) const;
+	template<class T> void scan(const std::vector<T>& moves, const char* text, std::size_t size,
+		std::vector<const char*>& blocked) const;
+
+public:
+	static const std::size_t MAX_TABLE = std::size_t(1) << 31;	//limit on states times row length
+
+	word_filter();
+
+	bool load(const char* path);										//builds from blocklist file; false if it could not be read
+	void build(const char* patterns, std::size_t size);				//builds from blocklist text
+	void clear();														//blocks nothing
+
+	static std::uint64_t fingerprint(const char* patterns, std::size_t size);	//changes whenever blocklist does; 0 if empty --
+																		//cheap, so a cache can be checked without building
+
+	bool empty() const { return class_count == 1; }					//whether filter blocks nothing
+	std::uint64_t fingerprint() const { return print; }				//fingerprint of blocklist filter was built from
+	bool blocks(std::string_view word) const;							//whether any pattern matches word
+	void find_blocked(const char* text, std::size_t size,
+		std::vector<const char*>& blocked) const;						//appends start of each line of text a pattern matches
+};
+
+#endif
@@ -5,99 +5,386 @@
 */
 
 #include "word_handler.h"
-#include <fstream>      //std::fstream
-#include <cctype>       //toupper 
+#include "ascii_compare.h"
+#include "edit_distance.h"
+#include "keystroke.h"
+#include "trace.h"
+#include <algorithm>      //std::nth_element
+#include <chrono>       //std::chrono::seconds
+#include <cstdint>      //SIZE_MAX, std::uint64_t
+#include <cstring>      //std::memcpy
+#include <istream>      //std::istream
+#include <ostream>      //std::ostream
+#include <utility>      //std::swap
 
 
-#include <algorithm>
+//length window of words for each enemy type, inclusive
+static const std::size_t type_lengths[word_handler::TYPES][2] = {
+    { 3, 4 },               //GOBLIN
+    { 5, 7 },               //GOB_SHAMAN
+    { 8, 10 },              //HOBGOBLIN
+    { 11, 13 },             //GOB_LORD
+    { 14, SIZE_MAX }        //GOB_PALADIN -- every longer word
+};
 
+word_handler::word_set::word_set() : bank(), dawg(), store(&bank), spelled(), type_words(), ranked(), generation(0),
+    readers(0), draining(false), drain_lock(), drained() {}
 
-word_handler::word_handler() : word_bank() {}
+void word_handler::word_set::clear() {
+    bank.clear();
+    dawg.clear();
+    store = &bank;
+    std::string().swap(spelled);
+    for (word_range& words : type_words)
+        words = word_range();
+    std::vector<std::uint32_t>().swap(ranked);
+}
+
+//only takes the lock if a drain is waiting -- a reader letting go of the live set never does
+//draining is set before readers is read, and read after readers is dropped, so one of the two sees the other
+void word_handler::word_set::release() const {
+    if (readers.fetch_sub(1) == 1 && draining.load())
+    {
+        std::lock_guard<std::mutex> lock(drain_lock);
+        drained.notify_all();
+    }
+}
+
+//a held word lasts as long as the player takes to type it, so this sleeps until its reader lets go
+void word_handler::word_set::drain() const {
+    draining.store(true);
+    {
+        std::unique_lock<std::mutex> lock(drain_lock);
+        drained.wait(lock, [this] { return readers.load() == 0; });
+    }
+    draining.store(false);
+}
+
+word_handler::word_bag::word_bag() : generation(0), seed(), draws(0), gen(), order(), cursor(0) {}
+
+void word_handler::word_bag::deal(std::uint64_t generation_, std::size_t count, const std::uint64_t seed_[4]) {
+    generation = generation_;
+    for (int i = 0; i < 4; ++i)
+        seed[i] = seed_[i];
+    draws = 0;
+    gen.set_state(seed);
+    order.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        order[i] = static_cast<std::uint32_t>(i);
+    cursor = 0;
+}
+
+//one step of fisher-yates -- swaps a random undrawn position to the front of what is left, and draws it
+//once all are drawn, the bag is shuffled again from where it stands, which is just as random as starting over
+std::size_t word_handler::word_bag::draw() {
+    if (cursor == order.size())
+        cursor = 0;
+    const std::size_t pick = cursor + static_cast<std::size_t>(gen.bounded(order.size() - cursor));
+    std::swap(order[cursor], order[pick]);
+    ++draws;
+    return order[cursor++];
+}
+
+word_handler::word_handler(rng* gen_, backend storage_, ranking order_, std::size_t memory_cap_) : gen(gen_),
+    storage(storage_), order(order_), memory_cap(memory_cap_), sets(), current(0), loads(0), bags(), graded(false), loading(), reloading() {
+    if (gen_ == nullptr) throw "word_handler(): invalid generator pointer!\n";
+    loading = std::async(std::launch::async, [this] { load_bank(sets[0]); index_bank(sets[0]); });
+}
+
+word_handler::~word_handler() {
+    //worker threads still refer to sets; let them finish
+    if (loading.valid())
+        loading.wait();
+    if (reloading.valid())
+        reloading.wait();
+}
+
+bool word_handler::ready() const {
+    return loading.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void word_handler::wait() const {
+    GOBLINS_TRACE_SCOPE("wait", "words");
+    loading.get();
+}
+
+void word_handler::load_bank(word_set& set) {
+    GOBLINS_TRACE_SCOPE("load_bank", "words");
+    word_bank& bank = set.bank;
 
-void word_handler::load_bank() {
-    //open file
-    std::ifstream words;
-    words.open("words.txt", std::ifstream::in);
-    if (!words.is_open())
+    //words.txt is the source of truth; words.gwb is its compiled cache
+    mapped_file text;
+    if (!text.open("words.txt"))
     {
+        //nothing to check cache against -- use compiled bank as is
         //file failed to open
-        throw "word(): failed to open file!\n";
-        return;
+        if (!bank.load("words.gwb"))
+            throw "word(): failed to open file!\n";
+    }
+    else
+    {
+        //words matching blocklist.txt, if there is one, are left out of the bank
+        mapped_file blocklist;
+        blocklist.open("blocklist.txt");
+        const std::uint64_t source_hash = word_bank::hash(text.data(), text.size())
+            ^ word_filter::fingerprint(blocklist.data(), blocklist.size());
+
+        //use cache if it was compiled from this words.txt and blocklist
+        if (!bank.load("words.gwb", text.size(), source_hash))
+        {
+            //cache missing or stale -- compile words.txt, and refresh cache for next launch if possible
+            word_filter filter;
+            filter.build(blocklist.data(), blocklist.size());
+            bank.build(text.data(), text.size(), memory_cap, &filter);
+            bank.save("words.gwb");
+        }
     }
 
-    //read each line -- program expects one word per line
-    std::string str;
-    while (getline(words, str))
+    //compiling checks the cap before it allocates; a cached bank is only checked here
+    if (memory_cap != 0 && bank.memory() > memory_cap)
     {
-        //check that length of string doesn't exceed max word length of word bank
-        if (str.size() >= word_bank.size())
+        bank.clear();
+        throw "load_bank(): word bank exceeds memory cap!\n";
+    }
+}
+
+//words are sorted by length, so each type's window is one contiguous run of the bank
+void word_handler::index_bank(word_set& set) {
+    GOBLINS_TRACE_SCOPE("index_bank", "words");
+    set.generation = ++loads;
+
+    //swap compiled bank for graph, if asked for -- and if it is smaller; lists without many shared affixes,
+    //or too large for a graph, stay packed
+    if (storage == DAWG)
+    {
+        try {
+            set.dawg.build(set.bank);
+        }
+        catch (const char*) {
+            set.dawg.clear();
+        }
+        if (set.dawg.replaces(set.bank))
         {
-            //resize to accommodate 
-            word_bank.resize(str.size() + 1);
+            set.bank.clear();
+            set.store = &set.dawg;
         }
+        else
+            set.dawg.clear();
+    }
+    const word_store* store = set.store;
+    word_range* type_words = set.type_words;
+    set.spelled.resize(store->max_length());
 
-        //insert into appropriate slot
-        word_bank[str.size()].push_back(str);
-    }
-    words.close();
-}
-
-const std::string word_handler::get_string(unsigned int type) const {
-
-    //determine upper, lower bounds of string length
-    long unsigned int range = 0, start = 0;
-    switch (type)
-    {
-    case 0:
-        range = 2;
-        start = 3;
-        break;
-    case 1:
-        range = 3;
-        start = 5;
-        break;
-    case 2:
-        range = 3;
-        start = 8;
-        break;
-    case 3:
-        range = 3;
-        start = 11;
-        break;
-    case 4:
-        range = word_bank.size() - 14;
-        start = 14;
-        break;
-    default:
-        throw "get_string(): invalid type!\n";
+    for (unsigned int type = 0; type < TYPES; ++type)
+    {
+        const std::size_t first = store->first(type_lengths[type][0]);
+        const std::size_t last = type_lengths[type][1] < store->max_length() ?
+            store->first(type_lengths[type][1] + 1) : store->size();
+        type_words[type].first = first;
+        type_words[type].count = last > first ? last - first : 0;
+    }
+
+    if (order == BY_TYPING)
+        rank_bank(set);
+}
+
+//re-deals the words of every length window by typing cost, keeping each type's word count
+//types only need the right set of words, not a sorted one, so each cut is a partial sort
+void word_handler::rank_bank(word_set& set) {
+    GOBLINS_TRACE_SCOPE("rank_bank", "words");
+    word_range* type_words = set.type_words;
+    const std::vector<float> costs = typing_costs(*set.store);
+
+    //cost above index, so plain integer order is easiest first, ties going to the earlier word --
+    //a seed always deals the same words, and the cuts below never look costs up
+    //(costs are never negative, so their bits sort like the floats do)
+    const std::size_t first = type_words[0].first;
+    std::vector<std::uint64_t> keys(costs.size() - first);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &costs[first + i], sizeof(bits));
+        keys[i] = (std::uint64_t(bits) << 32) | static_cast<std::uint32_t>(first + i);
+    }
+
+    std::size_t next = 0;
+    for (unsigned int type = 0; type < TYPES; ++type)
+    {
+        const std::size_t end = next + type_words[type].count;
+        if (type + 1 < TYPES)
+            std::nth_element(keys.begin() + next, keys.begin() + end, keys.end());
+        type_words[type].first = next;
+        next = end;
     }
 
-    //generate random word length that has words
-    long unsigned int word_length = start;
-    do
+    set.ranked.resize(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        set.ranked[i] = static_cast<std::uint32_t>(keys[i]);
+}
+
+//counts a reader on live set, then checks it is still live -- if a reload swapped sets in between,
+//backs off and tries the new one, so a reload never waits on a reader that has not started yet
+const word_handler::word_set& word_handler::acquire() const {
+    for (;;)
     {
-        word_length = static_cast<long unsigned int>(rand()) % range + start;
-    } while (word_bank[word_length].empty());
+        const unsigned int live = current.load();
+        sets[live].readers.fetch_add(1);
+        if (current.load() == live)
+            return sets[live];
+        sets[live].release();
+    }
+}
 
-    //return random word with that length in word bank
-    return word_bank[word_length][static_cast<long unsigned int>(rand()) % word_bank[word_length].size()];
+word_handler::held_word word_handler::get_string(unsigned int type) const {
+    GOBLINS_TRACE_SCOPE("get_string", "words");
+    //only blocks if the player got here before the bank finished loading
+    wait();
+
+    if (type >= TYPES)
+        throw "get_string(): invalid type!\n";
+    const word_set& set = acquire();
+    held_word held(std::string_view(), &set);  //lets set go if this throws
+    const word_range& words = set.type_words[type];
+    if (words.count == 0)
+        throw "get_string(): no words for type!\n";
+
+    //every word in the type's window is equally likely, but none comes up twice until all have
+    word_bag& bag = bags[type];
+    if (bag.generation != set.generation)
+    {
+        //first draw from these words -- bag gets its own stream, so its shuffle can be saved apart from the session
+        std::uint64_t seed[4];
+        rng(gen->next()).get_state(seed);
+        bag.deal(set.generation, words.count, seed);
+    }
+    std::size_t index = words.first + bag.draw();
+    if (!set.ranked.empty())
+        index = set.ranked[index];
+    held.text = set.store->word(index, &set.spelled[0]);
+    if (held.text.data() == set.spelled.data())
+    {
+        held.spelled.assign(held.text.data(), held.text.size());
+        held.text = held.spelled;
+    }
+    return held;
+}
+
+//one line per type: word count, bag's dealt generator state, and words drawn since
+void word_handler::save_bags(std::ostream& out) const {
+    wait();
+    out << "bags " << TYPES << '\n';
+    for (const word_bag& bag : bags)
+    {
+        out << bag.order.size();
+        for (std::uint64_t s : bag.seed)
+            out << ' ' << s;
+        out << ' ' << bag.draws << '\n';
+    }
 }
 
-bool word_handler::string_compare(std::string str1, const std::string str2) const {
-    //check that string length is same
-    if (str1.size() != str2.size())
+//deals each bag from its saved generator, and replays its draws
+bool word_handler::load_bags(std::istream& in) {
+    wait();
+
+    std::string tag;
+    unsigned int types = 0;
+    if (!(in >> tag >> types) || tag != "bags" || types != TYPES)
         return false;
-    else
+
+    //read everything before touching any bag
+    std::size_t counts[TYPES];
+    std::uint64_t seeds[TYPES][4], draws[TYPES];
+    for (unsigned int type = 0; type < TYPES; ++type)
+    {
+        if (!(in >> counts[type] >> seeds[type][0] >> seeds[type][1] >> seeds[type][2] >> seeds[type][3] >> draws[type]))
+            return false;
+    }
+
+    //bag is only meaningful for the words it was saved with; a bag never dealt saved as empty
+    const word_set& set = acquire();
+    held_word held(std::string_view(), &set);
+    for (unsigned int type = 0; type < TYPES; ++type)
     {
-        //check each letter against the other
-        long unsigned int strlen = str1.size();
-        for (long unsigned int i = 0; i < strlen; ++i)
+        if (counts[type] != 0 && counts[type] != set.type_words[type].count)
+            return false;
+    }
+
+    for (unsigned int type = 0; type < TYPES; ++type)
+    {
+        word_bag& bag = bags[type];
+        if (counts[type] == 0)
         {
-            //convert both to upper case
-            if (toupper(str1[i]) != toupper(str2[i]))
-                return false;
+            bag = word_bag();
+            continue;
         }
+        bag.deal(set.generation, counts[type], seeds[type]);
+        for (std::uint64_t i = 0; i < draws[type]; ++i)
+            bag.draw();
     }
     return true;
 }
 
+void word_handler::reshuffle() {
+    for (word_bag& bag : bags)
+        bag.generation = 0;
+}
+
+//builds new set in the spare slot while the live one keeps serving words, then swaps them
+//the old set is freed once the last word held from it is let go
+bool word_handler::reload() {
+    GOBLINS_TRACE_SCOPE("reload", "words");
+    if (!ready() || (reloading.valid() && !reloaded()))
+        return false;
+
+    reloading = std::async(std::launch::async, [this] {
+        const unsigned int live = current.load();
+        word_set& next = sets[live ^ 1];
+        try {
+            load_bank(next);
+            index_bank(next);
+            if (next.store->size() == 0)
+                throw "reload(): new word bank is empty!\n";
+        }
+        catch (...) {
+            //live set is untouched; drop what was built and report
+            next.clear();
+            throw;
+        }
+
+        current.store(live ^ 1);
+        sets[live].drain();
+        sets[live].clear();
+    });
+    return true;
+}
+
+bool word_handler::reloaded() const {
+    return !reloading.valid() || reloading.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void word_handler::wait_reload() const {
+    if (reloading.valid())
+        reloading.get();
+}
+
+bool word_handler::string_compare(std::string_view str1, std::string_view str2) const {
+    GOBLINS_TRACE_SCOPE("string_compare", "words");
+    return ascii_iequal(str1, str2);
+}
+
+std::size_t word_handler::string_match(std::string_view str, const std::string_view* candidates, std::size_t count) const {
+    GOBLINS_TRACE_SCOPE("string_match", "words");
+    return ascii_iequal_any(str, candidates, count);
+}
+
+double word_handler::accuracy(std::string_view target, std::string_view typed) const {
+    GOBLINS_TRACE_SCOPE("accuracy", "words");
+    if (target.empty())
+        return typed.empty() ? 1.0 : 0.0;
+
+    //one typo in a five letter word scores 0.8
+    const std::size_t edits = edit_distance(target, typed);
+    if (edits >= target.size())
+        return 0.0;
+    return 1.0 - static_cast<double>(edits) / static_cast<double>(target.size());
+}
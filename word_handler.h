@@ -7,21 +7,159 @@
 #ifndef WORD_HANDLER_H
 #define WORD_HANDLER_H
 
-#include <vector>	//std::vector
-#include <string>	//std::string
-#include <fstream>	//std::fstream
+#include "word_bank.h"
+#include "word_dawg.h"
+#include "rng.h"
+
+#include <string>		//std::string
+#include <string_view>	//std::string_view
+#include <future>		//std::shared_future
+#include <iosfwd>		//std::istream, std::ostream
+#include <atomic>		//std::atomic
+#include <condition_variable>	//std::condition_variable
+#include <mutex>		//std::mutex
+#include <vector>		//std::vector
+#include <cstdint>		//std::uint32_t
+#include <utility>		//std::move
 
 //reads in word bank, provides word and spell checks
 class word_handler {
-	std::vector<std::vector<std::string>> word_bank;						//list of alphabetized word list, sorted by length
 public:
-	word_handler();															//ctor
-	void load_bank();														//loads word bank from file -- will likely take some time
-	const std::string get_string(unsigned int type) const;							//gets string based on enemy type
-	bool string_compare(std::string str1, const std::string str2) const;	//case-insensitive string comparison function
+	static const unsigned int TYPES = 5;									//number of enemy types
+
+	//how loaded words are held in memory
+	enum backend {
+		PACKED,																//compiled bank as loaded -- fastest, mapped from words.gwb when possible
+		DAWG																//minimized word graph built from bank -- smallest for natural word lists;
+																			//stays PACKED for lists it would not shrink
+	};
+
+	//how words are sorted into enemy types
+	enum ranking {
+		BY_LENGTH,															//longer words for tougher enemies
+		BY_TYPING															//harder to type words for tougher enemies -- see keystroke.h;
+																			//each type keeps as many words as its length window holds
+	};
+
+private:
+	//run of words in bank, by index
+	struct word_range {
+		std::size_t first;
+		std::size_t count;
+	};
+
+	//everything loaded from one version of words.txt -- a reload builds a new one beside it
+	struct word_set {
+		word_bank bank;														//compiled word bank, sorted by length
+		word_dawg dawg;														//word graph -- only built for DAWG backend
+		const word_store* store;											//backend words are drawn from
+		mutable std::string spelled;										//scratch for a backend that cannot view its words
+		word_range type_words[TYPES];										//words each enemy type draws from
+		std::vector<std::uint32_t> ranked;									//BY_TYPING only -- word indices, easiest type's words first;
+																			//type_words then index this instead of the bank
+		std::uint64_t generation;											//which load filled set -- bags dealt from an older one start over
+		mutable std::atomic<unsigned int> readers;							//held_words still looking into this set
+		mutable std::atomic<bool> draining;									//whether drain is waiting on readers
+		mutable std::mutex drain_lock;
+		mutable std::condition_variable drained;							//woken when last reader lets go while draining
+
+		word_set();
+		void clear();														//releases words -- no reader may hold any
+		void release() const;												//lets go of a reader
+		void drain() const;													//blocks until no reader holds any words
+	};
+
+	//one type's words in shuffled order, drawn front to back -- no word repeats until every one has come up
+	//shuffled lazily, one swap per draw, so dealing a bag costs nothing but filling it in order
+	struct word_bag {
+		std::uint64_t generation;											//set bag was dealt from; 0 before first draw
+		std::uint64_t seed[4];												//bag's generator as dealt -- with draws, rebuilds bag exactly
+		std::uint64_t draws;												//words drawn since bag was dealt
+		rng gen;															//bag's own stream, seeded from session's
+		std::vector<std::uint32_t> order;									//positions in type's words; shuffled up to cursor
+		std::size_t cursor;													//next position to draw
+
+		word_bag();
+		void deal(std::uint64_t generation_, std::size_t count, const std::uint64_t seed_[4]);	//fills bag in order
+		std::size_t draw();													//next position in bag -- reshuffles once it runs out
+	};
+
+	rng* const gen;															//session's random number generator
+	const backend storage;													//backend chosen at construction
+	const ranking order;													//ranking chosen at construction
+	const std::size_t memory_cap;											//most bytes a compiled bank may take; 0 for no cap
+	word_set sets[2];														//live set, and the one a reload builds
+	std::atomic<unsigned int> current;										//index of live set in sets
+	std::uint64_t loads;													//loads started -- only touched by loading threads, one at a time
+	mutable word_bag bags[TYPES];											//each type's bag -- dealt on its first draw
+	bool graded;															//whether near misses earn partial credit
+	std::shared_future<void> loading;										//first load, on worker thread -- started by ctor
+	std::shared_future<void> reloading;										//latest reload, on worker thread
+
+	void load_bank(word_set& set);											//loads word bank from file -- will likely take some time
+	void index_bank(word_set& set);											//finds each enemy type's words in bank
+	void rank_bank(word_set& set);											//BY_TYPING only -- deals words out to types by typing cost
+	const word_set& acquire() const;										//live set, with a reader counted on it -- never blocks
+
+public:
+	//word drawn from bank -- keeps the set it came from alive, even if a reload replaces it
+	//a word the backend had to spell out is copied in, so it lasts as long as this does, too
+	class held_word {
+		std::string_view text;
+		std::string spelled;												//text, if backend could not view it -- short words stay
+																			//in place, never allocating
+		const word_set* set;												//set this holds a reader on; nullptr once moved from
+
+		friend class word_handler;
+
+	public:
+		held_word(std::string_view text_, const word_set* set_) : text(text_), spelled(), set(set_) {}
+		held_word(held_word&& other) : text(other.text), spelled(std::move(other.spelled)), set(other.set) {
+			if (!spelled.empty())
+				text = spelled;
+			other.set = nullptr;
+		}
+		held_word(const held_word&) = delete;
+		held_word& operator=(const held_word&) = delete;
+		~held_word() { if (set != nullptr) set->release(); }
+
+		std::string_view view() const { return text; }
+		operator std::string_view() const { return text; }
+	};
+
+	word_handler(rng* gen_, backend storage_ = PACKED, ranking order_ = BY_LENGTH,
+		std::size_t memory_cap_ = 0);										//ctor -- starts loading word bank in the background
+	~word_handler();														//dtor -- waits for loading to finish
+	word_handler(const word_handler&) = delete;
+	word_handler& operator=(const word_handler&) = delete;
+
+	bool ready() const;														//returns whether word bank has finished loading
+	void wait() const;														//blocks until word bank is loaded; rethrows load errors
+	held_word get_string(unsigned int type) const;							//gets string based on enemy type -- no copy with PACKED
+
+	//word bags -- a saved session picks up each type's shuffle where it left off
+	void save_bags(std::ostream& out) const;								//writes each bag's seed and draw count
+	bool load_bags(std::istream& in);										//rebuilds bags; false, leaving them as they were,
+																			//if saved for other words or unreadable
+	void reshuffle();														//drops every bag -- next draws deal new ones from session's
+																			//generator, just as after loading
+
+	//hot reload -- rereads words.txt on a worker thread, then swaps it in; words already held stay valid
+	bool reload();															//starts reload; false if a load is still running
+	bool reloaded() const;													//returns whether latest reload has finished -- only once old
+																			//set is freed, so not while a word from it is held
+	void wait_reload() const;												//blocks until latest reload is done; rethrows its errors
+	bool string_compare(std::string_view str1, std::string_view str2) const;	//case-insensitive string comparison function
+	std::size_t string_match(std::string_view str, const std::string_view* candidates,
+		std::size_t count) const;											//index of first candidate matching str, or count if none do
+
+	//graded typing
+	void set_graded(bool graded_) { graded = graded_; }					//turns partial credit for near misses on or off
+	bool is_graded() const { return graded; }
+	double accuracy(std::string_view target, std::string_view typed) const;	//1 minus edits per letter of target, floored at 0
 
 
 	//throwaway functions to get process words.txt -- todo -- delete
 };
 
-#endif
\ No newline at end of file
+#endif
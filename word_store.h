@@ -0,0 +1,27 @@
+/*
+* Justin W Li
+* word_store.h
+* word bank storage backend interface
+*/
+
+#ifndef WORD_STORE_H
+#define WORD_STORE_H
+
+#include <cstddef>		//std::size_t
+#include <string_view>	//std::string_view
+
+//read-only storage for a word bank
+//words are indexed in length order, so all words of one length form one run of indices
+class word_store {
+public:
+	virtual ~word_store() {}
+
+	virtual std::size_t size() const = 0;									//number of words
+	virtual std::size_t max_length() const = 0;								//length of longest word
+	virtual std::size_t first(std::size_t len) const = 0;					//index of first word with length len or longer
+	virtual std::string_view word(std::size_t index, char* buf) const = 0;	//word at index -- may be spelled out into buf,
+																			//which must hold max_length() letters
+	virtual std::size_t memory() const = 0;									//bytes used to hold words
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+* Justin W Li
+* work_pool.cpp
+* work-stealing thread pool function implementations
+*/
+
+#include "work_pool.h"
+
+work_pool::work_pool(unsigned int threads_) : threads(threads_), shares() {
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)			//core count unknown
+		threads = 1;
+	shares.reset(new share[threads]);
+}
+
+void work_pool::split(std::uint64_t jobs) {
+	std::uint64_t start = 0;
+	for (unsigned int i = 0; i < threads; ++i)
+	{
+		//first jobs % threads workers get one extra
+		std::uint64_t count = jobs / threads + (i < jobs % threads ? 1 : 0);
+		shares[i].next = start;
+		shares[i].end = start + count;
+		start += count;
+	}
+}
+
+bool work_pool::take(unsigned int worker, std::uint64_t& job) {
+	share& s = shares[worker];
+	std::lock_guard<std::mutex> hold(s.lock);
+	if (s.next == s.end)
+		return false;
+	job = s.next++;
+	return true;
+}
+
+bool work_pool::steal(unsigned int worker) {
+	for (;;)
+	{
+		//find fullest share -- sizes are only a hint until its lock is held
+		unsigned int victim = worker;
+		std::uint64_t most = 0;
+		for (unsigned int i = 0; i < threads; ++i)
+		{
+			if (i == worker)
+				continue;
+			std::lock_guard<std::mutex> hold(shares[i].lock);
+			if (shares[i].end - shares[i].next > most)
+			{
+				most = shares[i].end - shares[i].next;
+				victim = i;
+			}
+		}
+		if (victim == worker)
+			return false;
+
+		//take back half, rounded up, so a last job can be stolen too
+		//only one lock is held at a time -- worker's own share is empty, so no one else touches it meanwhile
+		std::uint64_t from, to;
+		{
+			share& v = shares[victim];
+			std::lock_guard<std::mutex> hold(v.lock);
+			if (v.next == v.end)
+				continue;		//emptied while looking; look again
+			to = v.end;
+			from = v.end - (v.end - v.next + 1) / 2;
+			v.end = from;
+		}
+		share& s = shares[worker];
+		std::lock_guard<std::mutex> hold(s.lock);
+		s.next = from;
+		s.end = to;
+		return true;
+	}
+}
@@ -0,0 +1,92 @@
+/*
+* Justin W Li
+* work_pool.h
+* work-stealing thread pool class definition
+*/
+
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <cstdint>		//std::uint64_t
+#include <exception>	//std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <memory>		//std::unique_ptr
+#include <mutex>		//std::mutex, std::lock_guard
+#include <thread>		//std::thread
+#include <vector>		//std::vector
+
+//-----------------------
+//----WORK POOL CLASS----
+//-----------------------
+
+//runs a batch of numbered, independent jobs on every core
+//each worker starts on an even share of the job numbers and works through it from the front; one that runs out
+//steals the back half of whichever share has most left, so workers finish together however long each job takes
+class work_pool {
+	//job numbers a worker has left -- [next, end) -- on a cache line of its own
+	struct alignas(64) share {
+		std::mutex lock;
+		std::uint64_t next;
+		std::uint64_t end;
+	};
+
+	unsigned int threads;
+	std::unique_ptr<share[]> shares;
+
+	void split(std::uint64_t jobs);						//deals every worker its share of jobs
+	bool take(unsigned int worker, std::uint64_t& job);	//next job of worker's share; false if it is empty
+	bool steal(unsigned int worker);					//moves half of fullest share to worker's; false if all are empty
+
+public:
+	explicit work_pool(unsigned int threads_ = 0);		//threads_ of 0 uses one per core
+	unsigned int size() const { return threads; }		//returns number of workers
+
+	//calls job(worker, index) once for every index in [0, jobs), and returns once all are done
+	//a worker's calls never overlap, so job can keep per-worker state indexed by worker
+	//the first exception thrown by a job is rethrown here, after the rest of the jobs are done
+	template<class F>
+	void run(std::uint64_t jobs, F job);
+};
+
+template<class F>
+void work_pool::run(std::uint64_t jobs, F job) {
+	split(jobs);
+
+	std::mutex error_lock;
+	std::exception_ptr error;
+	//a thief can empty a stolen range before take gets to it -- steal again until every share is empty
+	auto next = [this](unsigned int worker, std::uint64_t& index) {
+		while (!take(worker, index))
+		{
+			if (!steal(worker))
+				return false;
+		}
+		return true;
+	};
+	auto work = [&](unsigned int worker) {
+		std::uint64_t index;
+		while (next(worker, index))
+		{
+			try {
+				job(worker, index);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> hold(error_lock);
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+	};
+
+	//calling thread is worker 0
+	std::vector<std::thread> helpers;
+	for (unsigned int i = 1; i < threads; ++i)
+		helpers.emplace_back(work, i);
+	work(0);
+	for (std::thread& t : helpers)
+		t.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+#endif